@@ -0,0 +1,619 @@
+#include "algorithm_x.h"
+#include "sudoku.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/*
+ * This is the benchmark suite behind `make bench`. It runs a fixed set of
+ * workloads, each with 64-bit and with 32-bit links:
+ *
+ *  - Langford pairs (p. 68), counting all solutions;
+ *  - n queens, with the diagonals as secondary items, counting all solutions;
+ *  - batches of sudoku puzzles, solving each for its first solution, both with
+ *    a problem built for each puzzle and with one SudokuSolver for them all;
+ *  - packing the twelve pentominoes into rectangles, counting all solutions;
+ *  - random sparse matrices with a planted solution, counting all solutions.
+ *
+ * Every instance is generated here from fixed seeds, so runs are repeatable
+ * and comparable from one commit to the next. For each it reports the wall
+ * time of the best of several runs, the solutions and search nodes per second
+ * of that run, and the peak resident set size. Each workload runs in a process
+ * of its own, so that its peak memory is its own.
+ *
+ * --backend chooses the engine that searches the problems, as by
+ * use_backend(): automatic, dancing-links, bitset or dancing-cells. The table
+ * shows the one that ran, since the other engines leave some searches, such
+ * as those of the sudoku solver, to the dancing links.
+ *
+ * Besides the table printed, --json FILE appends one JSON object per line to
+ * FILE for each workload, tagged with the time of the run.
+ *
+ * Usage: benchmark [--json FILE] [--filter TEXT] [--runs N] [--backend NAME]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// An instance, in the form taken by the constructors of ExactCoverProblem.
+struct Instance {
+  std::vector<int64_t> primary;
+  std::vector<int64_t> secondary;
+  std::vector<std::vector<int64_t>> options;
+};
+
+Instance langford_pairs(int64_t n) {
+  Instance instance;
+  for (int64_t i = 1; i <= 3 * n; ++i) {
+    instance.primary.push_back(i);
+  }
+  for (int64_t i = 1; i <= n; ++i) {
+    for (int64_t k = i + 2; k <= 2 * n; ++k) {
+      int64_t j = k - i - 1;
+      instance.options.push_back({i, n + j, n + k});
+    }
+  }
+  return instance;
+}
+
+/* The primary items of the n queens problem are its rows and columns, and the
+ * secondary items its diagonals, as in Knuth ((23), p. 71).
+ */
+Instance queens(int64_t n) {
+  Instance instance;
+  for (int64_t i = 1; i <= 2 * n; ++i) {
+    instance.primary.push_back(i);
+  }
+  for (int64_t i = 1; i <= 4 * n - 2; ++i) {
+    instance.secondary.push_back(2 * n + i);
+  }
+  for (int64_t r = 0; r < n; ++r) {
+    for (int64_t c = 0; c < n; ++c) {
+      instance.options.push_back({1 + r, 1 + n + c, 2 * n + 1 + r + c,
+                                  2 * n + 2 * n + (r - c + n - 1)});
+    }
+  }
+  return instance;
+}
+
+/* The items of a sudoku grid with boxes of side b are its cells, and the
+ * pairings of each digit with each row, column and box. A given cell has only
+ * the option of its digit.
+ */
+Instance sudoku(int64_t b, const std::vector<int64_t> &grid) {
+  Instance instance;
+  int64_t n = b * b;
+  for (int64_t i = 1; i <= 4 * n * n; ++i) {
+    instance.primary.push_back(i);
+  }
+  for (int64_t r = 0; r < n; ++r) {
+    for (int64_t c = 0; c < n; ++c) {
+      for (int64_t d = 0; d < n; ++d) {
+        int64_t given = grid[r * n + c];
+        if (given >= 0 && given != d) {
+          continue;
+        }
+        int64_t box = (r / b) * b + c / b;
+        instance.options.push_back({1 + r * n + c, 1 + n * n + r * n + d,
+                                    1 + 2 * n * n + c * n + d,
+                                    1 + 3 * n * n + box * n + d});
+      }
+    }
+  }
+  return instance;
+}
+
+/* sudoku_puzzles() shuffles the rows, columns and digits of a filled grid and
+ * then keeps the given fraction of its cells, -1 marking the others. The
+ * puzzles need not have unique solutions, but they always have one.
+ */
+std::vector<std::vector<int64_t>> sudoku_puzzles(int64_t b, int64_t count,
+                                                 double given_fraction,
+                                                 uint32_t seed) {
+  std::mt19937 rng(seed);
+  int64_t n = b * b;
+  // rng() % k is used rather than the distributions, which vary by library.
+  auto shuffle = [&rng](std::vector<int64_t> &v) {
+    for (int64_t k = v.size() - 1; k > 0; --k) {
+      std::swap(v[k], v[rng() % (k + 1)]);
+    }
+  };
+  // A permutation of 0, ..., n - 1 that keeps the bands of b together.
+  auto banded = [&](void) {
+    std::vector<int64_t> bands(b);
+    std::vector<int64_t> order;
+    for (int64_t k = 0; k < b; ++k) {
+      bands[k] = k;
+    }
+    shuffle(bands);
+    for (int64_t band : bands) {
+      std::vector<int64_t> lines(b);
+      for (int64_t k = 0; k < b; ++k) {
+        lines[k] = band * b + k;
+      }
+      shuffle(lines);
+      order.insert(order.end(), lines.begin(), lines.end());
+    }
+    return order;
+  };
+  std::vector<std::vector<int64_t>> puzzles;
+  for (int64_t k = 0; k < count; ++k) {
+    std::vector<int64_t> rows = banded();
+    std::vector<int64_t> columns = banded();
+    std::vector<int64_t> digits(n);
+    for (int64_t d = 0; d < n; ++d) {
+      digits[d] = d;
+    }
+    shuffle(digits);
+    std::vector<int64_t> grid(n * n);
+    for (int64_t r = 0; r < n; ++r) {
+      for (int64_t c = 0; c < n; ++c) {
+        int64_t i = rows[r];
+        int64_t j = columns[c];
+        grid[r * n + c] = digits[(b * (i % b) + i / b + j) % n];
+        if (rng() % 1000 >= given_fraction * 1000) {
+          grid[r * n + c] = -1;
+        }
+      }
+    }
+    puzzles.push_back(std::move(grid));
+  }
+  return puzzles;
+}
+
+/* The items of a pentomino packing are the twelve pieces and the cells of the
+ * rectangle, and each option places a piece, in one of its orientations, on
+ * five cells.
+ */
+Instance pentominoes(int64_t height, int64_t width) {
+  const std::vector<std::vector<std::pair<int64_t, int64_t>>> shapes{
+      {{0, 1}, {0, 2}, {1, 0}, {1, 1}, {2, 1}},  // F
+      {{0, 0}, {0, 1}, {0, 2}, {0, 3}, {0, 4}},  // I
+      {{0, 0}, {1, 0}, {2, 0}, {3, 0}, {3, 1}},  // L
+      {{0, 1}, {1, 1}, {2, 0}, {2, 1}, {3, 0}},  // N
+      {{0, 0}, {0, 1}, {1, 0}, {1, 1}, {2, 0}},  // P
+      {{0, 0}, {0, 1}, {0, 2}, {1, 1}, {2, 1}},  // T
+      {{0, 0}, {0, 2}, {1, 0}, {1, 1}, {1, 2}},  // U
+      {{0, 0}, {1, 0}, {2, 0}, {2, 1}, {2, 2}},  // V
+      {{0, 0}, {1, 0}, {1, 1}, {2, 1}, {2, 2}},  // W
+      {{0, 1}, {1, 0}, {1, 1}, {1, 2}, {2, 1}},  // X
+      {{0, 1}, {1, 0}, {1, 1}, {2, 1}, {3, 1}},  // Y
+      {{0, 0}, {0, 1}, {1, 1}, {2, 1}, {2, 2}}}; // Z
+  Instance instance;
+  for (int64_t i = 1; i <= 12 + height * width; ++i) {
+    instance.primary.push_back(i);
+  }
+  for (int64_t piece = 0; piece < 12; ++piece) {
+    std::vector<std::vector<std::pair<int64_t, int64_t>>> orientations;
+    std::vector<std::pair<int64_t, int64_t>> cells = shapes[piece];
+    for (int64_t k = 0; k < 8; ++k) {
+      // Rotate a quarter turn each time, and reflect after the fourth.
+      for (std::pair<int64_t, int64_t> &cell : cells) {
+        cell = (k == 4) ? std::make_pair(cell.second, cell.first)
+                        : std::make_pair(cell.second, -cell.first);
+      }
+      int64_t top = cells[0].first;
+      int64_t left = cells[0].second;
+      for (const std::pair<int64_t, int64_t> &cell : cells) {
+        top = std::min(top, cell.first);
+        left = std::min(left, cell.second);
+      }
+      std::vector<std::pair<int64_t, int64_t>> normal;
+      for (const std::pair<int64_t, int64_t> &cell : cells) {
+        normal.push_back({cell.first - top, cell.second - left});
+      }
+      std::sort(normal.begin(), normal.end());
+      if (std::find(orientations.begin(), orientations.end(), normal) ==
+          orientations.end()) {
+        orientations.push_back(normal);
+      }
+    }
+    for (const std::vector<std::pair<int64_t, int64_t>> &shape :
+         orientations) {
+      for (int64_t r = 0; r < height; ++r) {
+        for (int64_t c = 0; c < width; ++c) {
+          std::vector<int64_t> option{piece + 1};
+          for (const std::pair<int64_t, int64_t> &cell : shape) {
+            int64_t y = r + cell.first;
+            int64_t x = c + cell.second;
+            if (y >= height || x >= width) {
+              break;
+            }
+            option.push_back(13 + y * width + x);
+          }
+          if (option.size() == 6) {
+            std::sort(option.begin() + 1, option.end());
+            instance.options.push_back(option);
+          }
+        }
+      }
+    }
+  }
+  return instance;
+}
+
+/* random_sparse() makes a matrix of the given numbers of items and options,
+ * each option with three to five items. The items are first split into random
+ * options, which make up a planted solution, and the rest are drawn at random.
+ */
+Instance random_sparse(int64_t item_count, int64_t option_count,
+                       uint32_t seed) {
+  std::mt19937 rng(seed);
+  Instance instance;
+  std::vector<int64_t> shuffled;
+  for (int64_t i = 1; i <= item_count; ++i) {
+    instance.primary.push_back(i);
+    shuffled.push_back(i);
+  }
+  for (int64_t k = item_count - 1; k > 0; --k) {
+    std::swap(shuffled[k], shuffled[rng() % (k + 1)]);
+  }
+  for (int64_t start = 0; start < item_count;) {
+    int64_t size = std::min<int64_t>(3 + rng() % 3, item_count - start);
+    std::vector<int64_t> option(shuffled.begin() + start,
+                                shuffled.begin() + start + size);
+    std::sort(option.begin(), option.end());
+    instance.options.push_back(option);
+    start += size;
+  }
+  while ((int64_t)instance.options.size() < option_count) {
+    int64_t size = 3 + rng() % 3;
+    std::vector<int64_t> option;
+    while ((int64_t)option.size() < size) {
+      int64_t i = 1 + rng() % item_count;
+      if (std::find(option.begin(), option.end(), i) == option.end()) {
+        option.push_back(i);
+      }
+    }
+    std::sort(option.begin(), option.end());
+    instance.options.push_back(option);
+  }
+  // Hide the planted options among the others.
+  for (int64_t k = instance.options.size() - 1; k > 0; --k) {
+    std::swap(instance.options[k], instance.options[rng() % (k + 1)]);
+  }
+  return instance;
+}
+
+using algorithm_x::Backend;
+
+// What one timed run of a workload found, and the engine that searched.
+struct Measurement {
+  uint64_t solutions;
+  uint64_t nodes;
+  Backend backend;
+};
+
+template <typename Problem>
+Measurement count_all(const Instance &instance, Backend backend) {
+  Problem p{instance.primary, instance.secondary, instance.options};
+  p.use_backend(backend);
+  Measurement m;
+  m.solutions = p.count_solutions();
+  m.nodes = p.search_node_count();
+  m.backend = p.search_backend();
+  return m;
+}
+
+template <typename Problem>
+Measurement solve_each(const std::vector<Instance> &batch, Backend backend) {
+  Measurement m{0, 0, backend};
+  for (const Instance &instance : batch) {
+    Problem p{instance.primary, instance.secondary, instance.options};
+    p.use_backend(backend);
+    p.solve(false);
+    m.solutions += p.stored_solutions().size();
+    m.nodes += p.search_node_count();
+    m.backend = p.search_backend();
+  }
+  return m;
+}
+
+/* solve_batch() solves each puzzle with one BasicSudokuSolver, built as part
+ * of the run.
+ */
+template <typename Index>
+Measurement solve_batch(int64_t b, const std::vector<std::string> &puzzles) {
+  algorithm_x::BasicSudokuSolver<Index> solver(b);
+  std::string solution(solver.side() * solver.side(), '.');
+  Measurement m{0, 0, Backend::dancing_links};
+  for (const std::string &puzzle : puzzles) {
+    m.solutions += solver.solve(puzzle.data(), &solution[0]);
+    m.nodes += solver.search_node_count();
+  }
+  return m;
+}
+
+/* A workload is timed by run(), given whether to use 32-bit links and the
+ * backend asked for. Anything outside run(), such as generating the
+ * instances, is not timed.
+ */
+using Timed = std::function<Measurement(bool, Backend)>;
+
+struct Workload {
+  std::string name;
+  std::string size;
+  std::function<Timed(void)> prepare;
+};
+
+template <typename Make>
+Workload counting(const std::string &name, const std::string &size,
+                  Make make) {
+  return {name, size, [make]() {
+            Instance instance = make();
+            return Timed([instance](bool compact, Backend backend) {
+              return compact
+                         ? count_all<algorithm_x::CompactExactCoverProblem>(
+                               instance, backend)
+                         : count_all<algorithm_x::ExactCoverProblem>(instance,
+                                                                     backend);
+            });
+          }};
+}
+
+Workload sudoku_batch(int64_t b, int64_t count, double given_fraction) {
+  std::string side = std::to_string(b * b);
+  return {"sudoku", std::to_string(count) + "x" + side + "x" + side,
+          [b, count, given_fraction]() {
+            std::vector<Instance> batch;
+            for (const std::vector<int64_t> &grid :
+                 sudoku_puzzles(b, count, given_fraction, 2019)) {
+              batch.push_back(sudoku(b, grid));
+            }
+            return Timed([batch](bool compact, Backend backend) {
+              return compact
+                         ? solve_each<algorithm_x::CompactExactCoverProblem>(
+                               batch, backend)
+                         : solve_each<algorithm_x::ExactCoverProblem>(batch,
+                                                                      backend);
+            });
+          }};
+}
+
+Workload sudoku_solver(int64_t b, int64_t count, double given_fraction) {
+  std::string side = std::to_string(b * b);
+  return {"sudoku-solver", std::to_string(count) + "x" + side + "x" + side,
+          [b, count, given_fraction]() {
+            std::vector<std::string> puzzles;
+            for (const std::vector<int64_t> &grid :
+                 sudoku_puzzles(b, count, given_fraction, 2019)) {
+              std::string puzzle;
+              for (int64_t d : grid) {
+                puzzle += d < 0 ? '.'
+                                : algorithm_x::SudokuSolver::symbol(d + 1);
+              }
+              puzzles.push_back(puzzle);
+            }
+            // The solver assumes the givens, which only the links do.
+            return Timed([b, puzzles](bool compact, Backend) {
+              return compact ? solve_batch<int32_t>(b, puzzles)
+                             : solve_batch<int64_t>(b, puzzles);
+            });
+          }};
+}
+
+std::vector<Workload> workloads() {
+  std::vector<Workload> all;
+  for (int64_t n : {8, 11, 12}) {
+    all.push_back(counting("langford", "n=" + std::to_string(n),
+                           [n]() { return langford_pairs(n); }));
+  }
+  for (int64_t n : {10, 11, 12}) {
+    all.push_back(counting("queens", "n=" + std::to_string(n),
+                           [n]() { return queens(n); }));
+  }
+  all.push_back(sudoku_batch(3, 1000, 0.35));
+  all.push_back(sudoku_batch(4, 100, 0.5));
+  all.push_back(sudoku_solver(3, 1000, 0.35));
+  all.push_back(sudoku_solver(4, 100, 0.5));
+  for (std::pair<int64_t, int64_t> shape :
+       {std::make_pair(3, 20), std::make_pair(4, 15)}) {
+    all.push_back(counting(
+        "pentominoes",
+        std::to_string(shape.first) + "x" + std::to_string(shape.second),
+        [shape]() { return pentominoes(shape.first, shape.second); }));
+  }
+  for (std::pair<int64_t, int64_t> shape :
+       {std::make_pair(60, 240), std::make_pair(80, 320),
+        std::make_pair(120, 360)}) {
+    all.push_back(counting(
+        "random",
+        std::to_string(shape.first) + "x" + std::to_string(shape.second),
+        [shape]() { return random_sparse(shape.first, shape.second, 1965); }));
+  }
+  return all;
+}
+
+// The result of a workload, as sent back by the process that ran it.
+struct Result {
+  double seconds;
+  uint64_t solutions;
+  uint64_t nodes;
+  int64_t peak_rss_kb;
+  Backend backend;
+};
+
+Result run(const Workload &workload, bool compact, Backend backend,
+           int64_t runs) {
+  Timed timed = workload.prepare();
+  Result result{0, 0, 0, 0, backend};
+  for (int64_t k = 0; k < runs; ++k) {
+    Clock::time_point start = Clock::now();
+    Measurement m = timed(compact, backend);
+    double time = seconds_since(start);
+    if (k == 0 || time < result.seconds) {
+      result.seconds = time;
+      result.solutions = m.solutions;
+      result.nodes = m.nodes;
+      result.backend = m.backend;
+    }
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  result.peak_rss_kb = usage.ru_maxrss;
+  return result;
+}
+
+/* run_apart() runs a workload in a child process, which sends back its result
+ * through a pipe, and returns false if the child failed.
+ */
+bool run_apart(const Workload &workload, bool compact, Backend backend,
+               int64_t runs, Result &result) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  // The child must not inherit any output still waiting to be written.
+  std::cout.flush();
+  pid_t child = fork();
+  if (child < 0) {
+    return false;
+  }
+  if (child == 0) {
+    close(fds[0]);
+    Result found = run(workload, compact, backend, runs);
+    ssize_t written = write(fds[1], &found, sizeof(found));
+    _exit(written == sizeof(found) ? 0 : 1);
+  }
+  close(fds[1]);
+  ssize_t got = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status;
+  waitpid(child, &status, 0);
+  return got == sizeof(result) && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0;
+}
+
+std::string timestamp() {
+  std::time_t now = std::time(nullptr);
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ",
+                std::gmtime(&now));
+  return buffer;
+}
+
+std::string to_json(const std::string &started, const Workload &workload,
+                    bool compact, int64_t runs, const Result &result) {
+  std::ostringstream ss;
+  ss << std::setprecision(9);
+  ss << "{\"started\": \"" << started << "\", \"workload\": \""
+     << workload.name << "\", \"size\": \"" << workload.size
+     << "\", \"links\": " << (compact ? 32 : 64) << ", \"backend\": \""
+     << algorithm_x::backend_name(result.backend) << "\", \"runs\": " << runs
+     << ", \"seconds\": " << result.seconds
+     << ", \"solutions\": " << result.solutions
+     << ", \"nodes\": " << result.nodes
+     << ", \"solutions_per_second\": " << result.solutions / result.seconds
+     << ", \"nodes_per_second\": " << result.nodes / result.seconds
+     << ", \"peak_rss_kb\": " << result.peak_rss_kb << "}";
+  return ss.str();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string json_path;
+  std::string filter;
+  int64_t runs = 3;
+  Backend backend = Backend::automatic;
+  bool is_usage = false;
+  for (int k = 1; k < argc && !is_usage; ++k) {
+    std::string arg = argv[k];
+    if (arg == "--backend" && k + 1 < argc) {
+      std::string name = argv[++k];
+      is_usage = true;
+      for (Backend known : {Backend::automatic, Backend::dancing_links,
+                            Backend::bitset, Backend::dancing_cells}) {
+        if (name == algorithm_x::backend_name(known)) {
+          backend = known;
+          is_usage = false;
+        }
+      }
+    } else if (arg == "--json" && k + 1 < argc) {
+      json_path = argv[++k];
+    } else if (arg == "--filter" && k + 1 < argc) {
+      filter = argv[++k];
+    } else if (arg == "--runs" && k + 1 < argc) {
+      runs = std::max<int64_t>(1, std::stoll(argv[++k]));
+    } else {
+      is_usage = true;
+    }
+  }
+  if (is_usage) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--json FILE] [--filter TEXT] [--runs N] [--backend NAME]\n"
+              << "NAME is automatic, dancing-links, bitset or "
+                 "dancing-cells.\n";
+    return 2;
+  }
+  std::ofstream json;
+  if (!json_path.empty()) {
+    json.open(json_path, std::ios::app);
+    if (!json) {
+      std::cerr << "Cannot open " << json_path << ".\n";
+      return 1;
+    }
+  }
+
+  std::string started = timestamp();
+  std::cout << std::left << std::setw(14) << "workload" << std::setw(14)
+            << "size" << std::right << std::setw(6) << "links" << std::setw(15)
+            << "backend" << std::setw(11)
+            << "time (s)" << std::setw(12) << "solutions" << std::setw(12)
+            << "sols/s" << std::setw(12) << "nodes/s" << std::setw(10)
+            << "peak MiB" << '\n';
+  int status = 0;
+  for (const Workload &workload : workloads()) {
+    if ((workload.name + " " + workload.size).find(filter) ==
+        std::string::npos) {
+      continue;
+    }
+    uint64_t solutions[2];
+    for (bool compact : {false, true}) {
+      Result result;
+      if (!run_apart(workload, compact, backend, runs, result)) {
+        std::cerr << "The workload " << workload.name << " " << workload.size
+                  << " failed.\n";
+        return 1;
+      }
+      solutions[compact] = result.solutions;
+      std::cout << std::left << std::setw(14) << workload.name
+                << std::setw(14) << workload.size << std::right
+                << std::setw(6) << (compact ? 32 : 64) << std::setw(15)
+                << algorithm_x::backend_name(result.backend) << std::fixed
+                << std::setprecision(4) << std::setw(11) << result.seconds
+                << std::setw(12) << result.solutions << std::setprecision(0)
+                << std::setw(12) << result.solutions / result.seconds
+                << std::setw(12) << result.nodes / result.seconds
+                << std::setprecision(1) << std::setw(10)
+                << result.peak_rss_kb / 1024.0 << std::endl;
+      if (json.is_open()) {
+        json << to_json(started, workload, compact, runs, result) << std::endl;
+      }
+    }
+    if (solutions[0] != solutions[1]) {
+      std::cerr << "Solution counts differ for " << workload.name << " "
+                << workload.size << ".\n";
+      status = 1;
+    }
+  }
+  return status;
+}
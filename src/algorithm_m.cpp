@@ -0,0 +1,442 @@
+#include "algorithm_x.h"
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace algorithm_x {
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::set_multiplicities(
+    std::vector<int64_t> lower, std::vector<int64_t> upper) {
+  if ((Index)lower.size() != primary_count ||
+      (Index)upper.size() != primary_count) {
+    throw std::invalid_argument("Every primary item must be given bounds.");
+  }
+  if (preprocessed) {
+    throw std::logic_error("A preprocessed problem cannot take "
+                           "multiplicities.");
+  }
+  // Abandon any search under way, which depends on the old bounds.
+  unwind();
+  search_state = SearchState::finished;
+  bool is_exact = true;
+  for (Index i = 0; i < primary_count; ++i) {
+    if (lower[i] < 0 || lower[i] > upper[i] || upper[i] < 1) {
+      throw std::invalid_argument("Multiplicities must satisfy "
+                                  "0 <= u <= v and v > 0.");
+    }
+    if (lower[i] != 1 || upper[i] != 1) {
+      is_exact = false;
+    }
+  }
+  bound.clear();
+  slack.clear();
+  if (!is_exact) {
+    /* As in Knuth, BOUND(i) counts down the options that item i may still
+     * take, and SLACK(i) is v - u, so that item i still needs
+     * BOUND(i) - SLACK(i) options.
+     */
+    bound.resize(primary_count + 1);
+    slack.resize(primary_count + 1);
+    for (Index i = 1; i <= primary_count; ++i) {
+      bound[i] = upper[i - 1];
+      slack[i] = upper[i - 1] - lower[i - 1];
+    }
+    /* Each level either chooses an option or passes over an item, and neither
+     * can happen twice, which bounds the depth of the search.
+     */
+    first_tweak.resize(option_count() + primary_count + 1);
+    candidate.reserve(option_count() + primary_count);
+  }
+  // Lengths alone no longer give the branching degree.
+  use_length_buckets(has_length_buckets);
+}
+
+/* branching_degree() is the number of ways in which Algorithm M can branch on
+ * item i, LEN(i) + 1 - max(BOUND(i) - SLACK(i), 0). For an item to be covered
+ * exactly once this is just LEN(i), as in the MRV heuristic.
+ */
+template <typename Index>
+Index BasicExactCoverProblem<Index>::branching_degree(Index i) {
+  Index needed = bound[i] - slack[i];
+  return len(i) + 1 - (needed > 0 ? needed : 0);
+}
+
+/* choose_item_to_branch() generalizes the MRV heuristic of
+ * choose_item_to_cover() to the branching degree, again taking the first item
+ * of the smallest.
+ */
+template <typename Index>
+Index BasicExactCoverProblem<Index>::choose_item_to_branch() {
+  Index smallest = std::numeric_limits<Index>::max();
+  Index smallest_index = -1;
+  Index i = items[0].rlink;
+  while (i != 0) {
+    ALGORITHM_X_COUNT(stats.mems += 4);
+    Index theta = branching_degree(i);
+    if (theta < smallest) {
+      smallest = theta;
+      smallest_index = i;
+      if (smallest == 0) {
+        break;
+      }
+    }
+    i = items[i].rlink;
+  }
+  return smallest_index;
+}
+
+/* tweak() removes x, the first node in the list of item p, from that list, and
+ * hides the rest of its option if hide_option is set. It is Knuth's tweak(x, p)
+ * or, without hiding, his tweak'(x, p), which is called once p has been
+ * covered and the option is hidden already.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::tweak(Index x, Index p, bool hide_option) {
+  if (hide_option) {
+    hide(x);
+  }
+  ALGORITHM_X_COUNT(stats.mems += 4);
+  ALGORITHM_X_COUNT(++stats.updates);
+  Index d = nodes[x].dlink;
+  nodes[p].dlink = d;
+  nodes[d].ulink = p;
+  --len(p);
+}
+
+/* untweak() restores the nodes removed from the list of item p by tweak(),
+ * from the first, a, up to the node that is now first in the list.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::untweak(Index a, Index p,
+                                            bool unhide_options) {
+  Index x = a;
+  Index y = p;
+  Index z = nodes[p].dlink;
+  nodes[p].dlink = x;
+  Index k = 0;
+  while (x != z) {
+    ALGORITHM_X_COUNT(stats.mems += 2);
+    nodes[x].ulink = y;
+    ++k;
+    if (unhide_options) {
+      unhide(x);
+    }
+    y = x;
+    x = nodes[x].dlink;
+  }
+  ALGORITHM_X_COUNT(stats.mems += 4);
+  nodes[z].ulink = y;
+  len(p) += k;
+}
+
+/* M4
+ * Prepare to branch on i at level l.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::prepare_to_branch(Index i, Index l) {
+  candidate.push_back(nodes[i].dlink);
+  --bound[i];
+  if (bound[i] == 0) {
+    cover(i);
+  }
+  if (bound[i] != 0 || slack[i] != 0) {
+    first_tweak[l] = candidate[l];
+  }
+}
+
+/* The part of M5 that follows the checks: x, which is about to be tried, is
+ * taken out of the list of i, so that it is not tried again below this level.
+ * If x is i itself, the search goes on without choosing another option for i,
+ * which then leaves the active list.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::tweak_option(Index x, Index i) {
+  if (bound[i] == 0 && slack[i] == 0) {
+    // That case is just as in Algorithm X.
+    return;
+  }
+  if (x != i) {
+    tweak(x, i, bound[i] != 0);
+  } else if (bound[i] != 0) {
+    Index p = items[i].llink;
+    Index q = items[i].rlink;
+    items[p].rlink = q;
+    items[q].llink = p;
+  }
+}
+
+/* M6
+ * Try x: each other primary item of its option has one less option to take,
+ * and is covered once it can take no more.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::try_option_with_bounds(Index x) {
+  Index p = x + 1;
+  while (p != x) {
+    Index j = nodes[p].top;
+    ALGORITHM_X_COUNT(stats.mems += 1 + (j <= 0));
+    if (j <= 0) {
+      p = nodes[p].ulink;
+    } else if (j <= primary_count) {
+      ALGORITHM_X_COUNT(++stats.mems);
+      --bound[j];
+      ++p;
+      if (bound[j] == 0) {
+        cover(j);
+      }
+    } else {
+      commit(p, j);
+      ++p;
+    }
+  }
+}
+
+/* M7
+ * Undo try_option_with_bounds(x).
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::untry_option_with_bounds(Index x) {
+  Index p = x - 1;
+  while (p != x) {
+    Index j = nodes[p].top;
+    ALGORITHM_X_COUNT(stats.mems += 1 + (j <= 0));
+    if (j <= 0) {
+      p = nodes[p].dlink;
+    } else if (j <= primary_count) {
+      ALGORITHM_X_COUNT(++stats.mems);
+      ++bound[j];
+      --p;
+      if (bound[j] == 1) {
+        uncover(j);
+      }
+    } else {
+      uncommit(p, j);
+      --p;
+    }
+  }
+}
+
+/* M8
+ * Restore i, undoing prepare_to_branch(i, l) and the tweaks made since.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::restore_item(Index i, Index l) {
+  if (bound[i] == 0 && slack[i] == 0) {
+    uncover(i);
+  } else if (bound[i] != 0) {
+    untweak(first_tweak[l], i, true);
+  } else {
+    untweak(first_tweak[l], i, false);
+    uncover(i);
+  }
+  ++bound[i];
+  candidate.pop_back();
+}
+
+/* M9, for a level l that chose no option for its item i: put i back in the
+ * active list, if tweak_option() took it out.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::reactivate_item(Index i) {
+  if (bound[i] != 0) {
+    Index p = items[i].llink;
+    Index q = items[i].rlink;
+    items[p].rlink = i;
+    items[q].llink = i;
+  }
+}
+
+template <typename Index>
+bool BasicExactCoverProblem<Index>::algorithm_m() {
+  /*
+   * This is an implementation of Donald Knuth's Algorithm M, exact covering
+   * with multiplicities, from _The Art of Computer Programming_, volume 4,
+   * fascicle 5. Each primary item i is to be covered at least u and at most v
+   * times. The search branches on an item by trying each of its options in
+   * turn, removing each from the item's list once it has been tried, so that
+   * options chosen for the same item at deeper levels follow it; the last
+   * branch, if the item has enough options already, chooses none.
+   *
+   * Like algorithm_x(), it returns true at each solution and resumes at M9 when
+   * next called. The candidate stack holds x_l as in Knuth: a node, or the item
+   * i itself for the branch that passes over i.
+   */
+  Index l = level;
+  Index i;
+  Index x;
+
+  switch (search_state) {
+  case SearchState::enter_level:
+    goto m2;
+  case SearchState::try_option:
+    x = candidate[l];
+    i = (x <= primary_count) ? x : nodes[x].top;
+    goto m5;
+  case SearchState::leave_level:
+    goto m9;
+  case SearchState::finished:
+    return false;
+  }
+
+  /* M2
+   * Enter level l.
+   */
+m2:
+  if (search_nodes >= next_check && !within_limits(l)) {
+    level = l;
+    search_state = SearchState::enter_level;
+    return false;
+  }
+  ++search_nodes;
+  ALGORITHM_X_COUNT(stats.count_node(l));
+  ALGORITHM_X_COUNT(++stats.mems);
+  if (items[0].rlink == 0) {
+    ALGORITHM_X_COUNT(++stats.solutions);
+    ++solutions_found;
+    if (limits.solutions > 0) {
+      next_check = search_nodes;
+    }
+    level = l;
+    search_state = SearchState::leave_level;
+    return true;
+  }
+  if (work_queue != nullptr) {
+    share_work(l);
+  }
+
+  /* M3
+   * Choose i, with the smallest branching degree.
+   */
+  // m3:
+  i = choose_item_to_branch();
+  if (branching_degree(i) == 0) {
+    goto m9;
+  }
+
+  /* M4
+   * Prepare to branch on i.
+   */
+  // m4:
+  prepare_to_branch(i, l);
+
+  /* M5
+   * Possibly tweak x_l.
+   */
+m5:
+  x = candidate[l];
+  if (bound[i] == 0 && slack[i] == 0) {
+    if (x == i) {
+      goto m8;
+    }
+  } else if (len(i) <= bound[i] - slack[i]) {
+    // Too few options are left for i to be covered often enough.
+    goto m8;
+  }
+  tweak_option(x, i);
+
+  /* M6
+   * Try x_l.
+   */
+  // m6:
+  if (x != i) {
+    try_option_with_bounds(x);
+  }
+  ++l;
+  goto m2;
+
+  /* M7
+   * Try again.
+   */
+m7:
+  untry_option_with_bounds(candidate[l]);
+  i = nodes[candidate[l]].top;
+  candidate[l] = nodes[candidate[l]].dlink;
+  goto m5;
+
+  /* M8
+   * Restore i.
+   */
+m8:
+  restore_item(i, l);
+
+  /* M9
+   * Leave level l.
+   */
+m9:
+  if (l == root_level) {
+    level = l;
+    search_state = SearchState::finished;
+    return false;
+  }
+  --l;
+  if (candidate[l] <= primary_count) {
+    i = candidate[l];
+    reactivate_item(i);
+    goto m8;
+  }
+  i = nodes[candidate[l]].top;
+  goto m7;
+}
+
+/* replay_level_with_bounds() is replay_level() for Algorithm M. Level l is
+ * entered as in M4, and the options of its item that precede x are tweaked,
+ * just as they were when the search moved past them. Then x is tried, as in
+ * M5 and M6, if is_tried is set.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::replay_level_with_bounds(Index x, Index l,
+                                                             bool is_tried) {
+  Index i = (x <= primary_count) ? x : nodes[x].top;
+  prepare_to_branch(i, l);
+  while (candidate[l] != x) {
+    tweak_option(candidate[l], i);
+    candidate[l] = nodes[candidate[l]].dlink;
+  }
+  if (is_tried) {
+    tweak_option(x, i);
+    if (x != i) {
+      try_option_with_bounds(x);
+    }
+  }
+}
+
+/* unwind_with_bounds() is unwind() for Algorithm M: it undoes M6, then M8, for
+ * every level on the candidate stack.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::unwind_with_bounds() {
+  while (!candidate.empty()) {
+    Index l = candidate.size() - 1;
+    Index x = candidate[l];
+    Index i;
+    if (x <= primary_count) {
+      i = x;
+      reactivate_item(i);
+    } else {
+      i = nodes[x].top;
+      untry_option_with_bounds(x);
+    }
+    restore_item(i, l);
+  }
+}
+
+template void
+BasicExactCoverProblem<int32_t>::set_multiplicities(std::vector<int64_t>,
+                                                    std::vector<int64_t>);
+template void
+BasicExactCoverProblem<int64_t>::set_multiplicities(std::vector<int64_t>,
+                                                    std::vector<int64_t>);
+template bool BasicExactCoverProblem<int32_t>::algorithm_m();
+template bool BasicExactCoverProblem<int64_t>::algorithm_m();
+template void
+BasicExactCoverProblem<int32_t>::replay_level_with_bounds(int32_t, int32_t,
+                                                          bool);
+template void
+BasicExactCoverProblem<int64_t>::replay_level_with_bounds(int64_t, int64_t,
+                                                          bool);
+template void BasicExactCoverProblem<int32_t>::unwind_with_bounds();
+template void BasicExactCoverProblem<int64_t>::unwind_with_bounds();
+
+} // namespace algorithm_x
@@ -3,28 +3,104 @@
 #include <cstdint>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace algorithm_x {
 
-ExactCoverProblem::ExactCoverProblem(std::string i,
-                                     std::vector<std::string> o) {
+namespace {
+
+/* An ItemIndex finds the number of an item from its name, in constant time.
+ * Names that are small integers, as characters are, index a table directly;
+ * other names are hashed.
+ */
+class ItemIndex {
+public:
+  explicit ItemIndex(const std::vector<int64_t> &names) : lowest(0) {
+    int64_t n = names.size();
+    if (n == 0) {
+      return;
+    }
+    auto range = std::minmax_element(names.begin(), names.end());
+    lowest = *range.first;
+    uint64_t span = (uint64_t)*range.second - (uint64_t)lowest;
+    is_dense = span < 2 * (uint64_t)n + 256;
+    if (is_dense) {
+      table.assign(span + 1, 0);
+    } else {
+      hashed.reserve(n);
+    }
+    for (int64_t i = 1; i <= n; ++i) {
+      int64_t &entry = is_dense ? table[(uint64_t)names[i - 1] - lowest]
+                                : hashed[names[i - 1]];
+      if (entry != 0) {
+        throw std::invalid_argument("Items must have distinct names.");
+      }
+      entry = i;
+    }
+  }
+
+  // find() returns the number of the item with the given name, or 0 if none.
+  int64_t find(int64_t name) const {
+    if (is_dense) {
+      uint64_t k = (uint64_t)name - lowest;
+      return k < table.size() ? table[k] : 0;
+    }
+    auto found = hashed.find(name);
+    return found == hashed.end() ? 0 : found->second;
+  }
+
+private:
+  int64_t lowest;
+  bool is_dense = true;
+  std::vector<int64_t> table;
+  std::unordered_map<int64_t, int64_t> hashed;
+};
+
+} // namespace
+
+template <typename Index>
+BasicExactCoverProblem<Index>::BasicExactCoverProblem(
+    std::string i, std::vector<std::string> o)
+    : BasicExactCoverProblem(std::move(i), std::string(), std::move(o)) {}
+
+template <typename Index>
+BasicExactCoverProblem<Index>::BasicExactCoverProblem(
+    std::string primary, std::string secondary, std::vector<std::string> o) {
   has_string_description = true;
   // First, copy over the items description.
-  items_description.reserve(i.size());
-  for (char c : i) {
+  items_description.reserve(primary.size() + secondary.size());
+  for (char c : primary) {
+    items_description.push_back(c);
+  }
+  for (char c : secondary) {
     items_description.push_back(c);
   }
+  primary_count = primary.size();
 
-  // Next, copy over the options description.
+  /* Next, copy over the options description. A colon after an item gives it
+   * the color of the character that follows.
+   */
   options_description.reserve(o.size());
   for (const std::string &option_name : o) {
     options_description.push_back({});
+    colors_description.push_back({});
     std::vector<int64_t> &option = options_description.back();
-    for (char c : option_name) {
-      option.push_back(c);
+    std::vector<int64_t> &colors = colors_description.back();
+    for (int64_t k = 0; k < (int64_t)option_name.size(); ++k) {
+      if (option_name[k] == ':' && !option.empty() &&
+          k + 1 < (int64_t)option_name.size()) {
+        ++k;
+        colors.back() = option_name[k];
+      } else {
+        option.push_back(option_name[k]);
+        colors.push_back(0);
+      }
     }
   }
 
@@ -34,56 +110,165 @@ ExactCoverProblem::ExactCoverProblem(std::string i,
   return;
 }
 
-ExactCoverProblem::ExactCoverProblem(std::vector<int64_t> i,
-                                     std::vector<std::vector<int64_t>> o) {
+template <typename Index>
+BasicExactCoverProblem<Index>::BasicExactCoverProblem(
+    std::vector<int64_t> i, std::vector<std::vector<int64_t>> o)
+    : BasicExactCoverProblem(std::move(i), std::vector<int64_t>(),
+                             std::move(o)) {}
+
+template <typename Index>
+BasicExactCoverProblem<Index>::BasicExactCoverProblem(
+    std::vector<int64_t> primary, std::vector<int64_t> secondary,
+    std::vector<std::vector<int64_t>> o,
+    std::vector<std::vector<int64_t>> colors) {
   has_string_description = false;
-  // First, copy over the problem description.
-  this->items_description = i;
-  this->options_description = o;
+  // First, take over the problem description.
+  this->primary_count = primary.size();
+  this->items_description = std::move(primary);
+  this->items_description.insert(this->items_description.end(),
+                                 secondary.begin(), secondary.end());
+  this->options_description = std::move(o);
+  this->colors_description = std::move(colors);
 
-  // Having copied the description, allocate the intrinsic data structures.
+  // Having taken the description, allocate the intrinsic data structures.
   initialize_problem();
   return;
 }
 
-ExactCoverProblem::ExactCoverProblem(ExactCoverProblem &other) = default;
+template <typename Index>
+BasicExactCoverProblem<Index>::BasicExactCoverProblem()
+    : has_string_description(false), primary_count(0) {}
 
-ExactCoverProblem::ExactCoverProblem(ExactCoverProblem &&other) = default;
+template <typename Index>
+BasicExactCoverProblem<Index>::BasicExactCoverProblem(
+    BasicExactCoverProblem &other) = default;
 
-ExactCoverProblem &ExactCoverProblem::
-operator=(ExactCoverProblem &other) = default;
+template <typename Index>
+BasicExactCoverProblem<Index>::BasicExactCoverProblem(
+    BasicExactCoverProblem &&other) = default;
 
-ExactCoverProblem &ExactCoverProblem::
-operator=(ExactCoverProblem &&other) = default;
+template <typename Index>
+BasicExactCoverProblem<Index> &BasicExactCoverProblem<Index>::
+operator=(BasicExactCoverProblem &other) = default;
 
-ExactCoverProblem::~ExactCoverProblem() {}
+template <typename Index>
+BasicExactCoverProblem<Index> &BasicExactCoverProblem<Index>::
+operator=(BasicExactCoverProblem &&other) = default;
 
-void ExactCoverProblem::initialize_problem() {
-  // The problem is initialized in an unsolved state.
-  solved = false;
+template <typename Index>
+BasicExactCoverProblem<Index>::~BasicExactCoverProblem() {}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::initialize_problem() {
+  ALGORITHM_X_TIME(stats.initialize_seconds);
+  initialize_colors();
   initialize_items();
   initialize_nodes();
-  candidate.reserve(options_description.size());
+  initialize_search();
+}
+
+// initialize_search() readies a problem whose links are in place to be solved.
+template <typename Index>
+void BasicExactCoverProblem<Index>::initialize_search() {
+  // The problem is initialized in an unsolved state.
+  solved = false;
+  preprocessed = false;
+  status = SearchStatus::complete;
+  next_check = std::numeric_limits<uint64_t>::max();
+  solutions_found = 0;
+  resume_pending = false;
+  backend = Backend::automatic;
+  used_backend = Backend::dancing_links;
+  search_engine = Backend::dancing_links;
+  work_queue = nullptr;
+  search_state = SearchState::finished;
+  search_nodes = 0;
+  has_length_buckets = false;
+  use_length_buckets(primary_count >= length_bucket_threshold);
+  /* Options that all have the same number of items, from 2 to 6, are walked
+   * by the paths specialized for that width; see hide_fixed(). Their spacers
+   * then stand every option_width + 1 nodes.
+   */
+  option_base = items_description.size() + 2;
+  option_width = 0;
+  int64_t options = option_count();
+  if (options > 0 && (int64_t)nodes.size() > option_base) {
+    int64_t width = (nodes.size() - option_base) / options - 1;
+    bool is_fixed =
+        width >= 2 && width <= 6 &&
+        (int64_t)nodes.size() == option_base + options * (width + 1);
+    for (int64_t k = 1; is_fixed && k <= options; ++k) {
+      is_fixed = nodes[option_base - 1 + k * (width + 1)].top == -k;
+    }
+    option_width = is_fixed ? width : 0;
+  }
+  candidate.reserve(option_count());
+  chosen_options.reserve(option_count());
 }
 
-void ExactCoverProblem::initialize_items() {
-  // The first item is a header; the rest correspond with the items.
-  items.resize(items_description.size() + 1);
+/* initialize_colors() checks that only secondary items have colors, and drops
+ * the colors altogether if no item has one, so that the search can skip
+ * checking them.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::initialize_colors() {
+  if (colors_description.empty()) {
+    return;
+  }
+  if (colors_description.size() != options_description.size()) {
+    throw std::invalid_argument("Every option must be given its colors.");
+  }
+  bool has_colors = false;
+  for (int64_t k = 0; k < (int64_t)options_description.size(); ++k) {
+    if (colors_description[k].size() != options_description[k].size()) {
+      throw std::invalid_argument("Every item of an option must be given "
+                                  "a color, or 0 for none.");
+    }
+    for (int64_t m = 0; m < (int64_t)colors_description[k].size(); ++m) {
+      if (colors_description[k][m] == 0) {
+        continue;
+      }
+      if (colors_description[k][m] < 0) {
+        throw std::invalid_argument("Colors must be positive.");
+      }
+      has_colors = true;
+    }
+  }
+  if (!has_colors) {
+    colors_description.clear();
+  }
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::initialize_items() {
+  /* The first item is a header; the rest correspond with the items. The name
+   * of item i is items_description[i - 1]. As in Knuth's Algorithm C, the
+   * primary items 1, ..., N_1 form a list headed by item 0, which is what the
+   * search works through, and the secondary items N_1 + 1, ..., N form another
+   * headed by item N + 1.
+   */
+  Index n = items_description.size();
+  Index n_1 = primary_count;
+  items.resize(n + 2);
   // Inialize the header.
-  items[0].name = 0;
-  items[0].llink = items.size() - 1;
-  items[0].rlink = 1;
+  items[0].llink = n_1;
+  items[0].rlink = (n_1 > 0) ? 1 : 0;
   // Initialize the item nodes.
-  int64_t i = 1;
-  for (int64_t item_name : items_description) {
-    items[i].name = item_name;
+  for (Index i = 1; i <= n_1; ++i) {
     items[i].llink = i - 1;
-    items[i].rlink = ((int64_t)items.size() != i + 1) ? (i + 1) : 0;
-    ++i;
+    items[i].rlink = (i < n_1) ? (i + 1) : 0;
+  }
+  // Then the secondary items.
+  items[n + 1].llink = (n > n_1) ? n : n + 1;
+  items[n + 1].rlink = (n > n_1) ? n_1 + 1 : n + 1;
+  for (Index i = n_1 + 1; i <= n; ++i) {
+    items[i].llink = (i > n_1 + 1) ? (i - 1) : n + 1;
+    items[i].rlink = (i < n) ? (i + 1) : n + 1;
   }
 }
 
-void ExactCoverProblem::initialize_nodes() {
+template <typename Index>
+void BasicExactCoverProblem<Index>::initialize_nodes() {
   /*
    * First, find the right number of nodes. This count is based on the diagram
    * shown in Knuth (p.66).
@@ -99,52 +284,80 @@ void ExactCoverProblem::initialize_nodes() {
    * The logic below simply carries this calculation out.
    */
 
-  int64_t node_count = items.size() + options_description.size() + 1;
+  int64_t node_count =
+      items_description.size() + 1 + options_description.size() + 1;
   for (const std::vector<int64_t> &option_name : options_description) {
     node_count += option_name.size();
   }
+  if (node_count > (int64_t)std::numeric_limits<Index>::max()) {
+    throw std::length_error("Problem instance has too many nodes "
+                            "for the index type of its links.");
+  }
 
   nodes.resize(node_count);
+  if (!colors_description.empty()) {
+    node_colors.resize(node_count);
+    last_plain_item = primary_count;
+  } else {
+    // No node will ever be purified.
+    last_plain_item = items_description.size();
+  }
 
   /* Now we allocate.
    */
 
   // i is the index of the node being allocated. We begin with the first node.
-  int64_t i = 0;
+  Index i = 0;
   // Allocate the header.
-  ItemNode *item_node = (ItemNode *)&nodes[i];
-  item_node->len = 0;
-  item_node->ulink = 0;
-  item_node->dlink = 0;
+  len(i) = 0;
+  nodes[i].ulink = 0;
+  nodes[i].dlink = 0;
 
   // Allocate one item node for each item.
-  for (i = 1; i <= (int64_t)items_description.size(); ++i) {
-    item_node = (ItemNode *)&nodes[i];
+  for (i = 1; i <= (Index)items_description.size(); ++i) {
     /* To begin with, each item is listed in no options, and all its links are
      * self-references. This is essential for how later nodes are then added in.
      */
-    item_node->len = 0;
-    item_node->ulink = i;
-    item_node->dlink = i;
+    len(i) = 0;
+    nodes[i].ulink = i;
+    nodes[i].dlink = i;
   }
 
   // Initialize first spacer and increment the node index.
   nodes[i].top = 0;
   nodes[i].ulink = 0;
-  nodes[i].dlink = i + options_description[0].size();
+  nodes[i].dlink =
+      i + (options_description.empty() ? 0 : options_description[0].size());
   ++i;
 
-  int64_t option_index = 1;
+  Index option_index = 1;
+  ItemIndex item_index(items_description);
+  /* seen_in[j] is the last option found to contain item j, which catches an
+   * option listing an item twice.
+   */
+  std::vector<Index> seen_in(items_description.size() + 1, 0);
 
   for (const std::vector<int64_t> &option_name : options_description) {
-    int64_t item_index = 1;
+    // Each option may list its items in any order.
+    int64_t m = 0;
     for (int64_t option_item : option_name) {
-      while (items[item_index].name < option_item) {
-        ++item_index;
+      Index j = item_index.find(option_item);
+      if (j == 0) {
+        throw std::invalid_argument("Option items must be known.");
+      }
+      if (seen_in[j] == option_index) {
+        throw std::invalid_argument("An option cannot list an item twice.");
+      }
+      seen_in[j] = option_index;
+      place_node(i, j);
+      if (!node_colors.empty()) {
+        node_colors[i] = colors_description[option_index - 1][m];
+        if (node_colors[i] != 0 && j <= primary_count) {
+          throw std::invalid_argument("Only secondary items can have colors.");
+        }
       }
-      place_node(i, item_index);
       ++i;
-      ++item_index;
+      ++m;
     }
     // Having allocated the option's nodes, allocate a tailing spacer.
     place_spacer(i, option_index);
@@ -153,7 +366,9 @@ void ExactCoverProblem::initialize_nodes() {
   }
 }
 
-void ExactCoverProblem::place_spacer(int64_t node_index, int64_t option_index) {
+template <typename Index>
+void BasicExactCoverProblem<Index>::place_spacer(Index node_index,
+                                                 Index option_index) {
   Node *node = &nodes[node_index]; // The node to be set.
   /* Per Knuth (p. 67), ulink will be the index of the last node of the next
    * option; ulink will be the index of the first node of the previous option.
@@ -174,7 +389,7 @@ void ExactCoverProblem::place_spacer(int64_t node_index, int64_t option_index) {
   /* If this option isn't for the last spacer, have dlink point into nodes
    * for the next option.
    */
-  if (option_index < (int64_t)options_description.size()) {
+  if (option_index < (Index)options_description.size()) {
     node->dlink = node_index + options_description[option_index].size();
   }
   // Otherwise, there is no such node. Set the null link.
@@ -183,11 +398,12 @@ void ExactCoverProblem::place_spacer(int64_t node_index, int64_t option_index) {
   }
 }
 
-void ExactCoverProblem::place_node(int64_t node_index, int64_t item_index) {
-  ItemNode *item_node =
-      (ItemNode *)&nodes[item_index]; // The node for this item.
-  Node *node = &nodes[node_index];    // The node to be set.
-  if (item_node->ulink == (int64_t)item_index) {
+template <typename Index>
+void BasicExactCoverProblem<Index>::place_node(Index node_index,
+                                               Index item_index) {
+  Node *item_node = &nodes[item_index]; // The node for this item.
+  Node *node = &nodes[node_index];      // The node to be set.
+  if (item_node->ulink == item_index) {
     /* If item_node's dlink is a self-reference, no options have been added to
      * this item before.
      */
@@ -195,7 +411,7 @@ void ExactCoverProblem::place_node(int64_t node_index, int64_t item_index) {
     node->ulink = item_index;
   } else {
     // Otherwise, there is a regular node above this. Grab it.
-    int64_t prev_index = item_node->ulink;
+    Index prev_index = item_node->ulink;
     Node *prev_node = &nodes[prev_index];
     prev_node->dlink = node_index;
     node->ulink = prev_index;
@@ -208,116 +424,764 @@ void ExactCoverProblem::place_node(int64_t node_index, int64_t item_index) {
   // The node's top will be the item.
   node->top = item_index;
   // Also increment the length of item.
-  (item_node->len) += 1;
+  ++len(item_index);
 }
 
-void ExactCoverProblem::cover(int64_t i) {
-  int64_t p = nodes[i].dlink;
-  while (p != i) {
-    hide(p);
-    p = nodes[p].dlink;
+template <typename Index>
+void BasicExactCoverProblem<Index>::cover(Index i) {
+  switch (option_width) {
+  case 2:
+    hide_list<2>(i);
+    break;
+  case 3:
+    hide_list<3>(i);
+    break;
+  case 4:
+    hide_list<4>(i);
+    break;
+  case 5:
+    hide_list<5>(i);
+    break;
+  case 6:
+    hide_list<6>(i);
+    break;
+  default:
+    hide_list<0>(i);
   }
-  int64_t l = items[i].llink;
-  int64_t r = items[i].rlink;
+  ALGORITHM_X_COUNT(stats.mems += 5);
+  Index l = items[i].llink;
+  Index r = items[i].rlink;
   items[l].rlink = r;
   items[r].llink = l;
+  if (i <= last_bucketed_item) {
+    length_buckets.erase(i, len(i));
+  }
 }
 
-void ExactCoverProblem::uncover(int64_t i) {
-  int64_t l = items[i].llink;
-  int64_t r = items[i].rlink;
+template <typename Index>
+void BasicExactCoverProblem<Index>::uncover(Index i) {
+  ALGORITHM_X_COUNT(stats.mems += 5);
+  Index l = items[i].llink;
+  Index r = items[i].rlink;
   items[l].rlink = i;
   items[r].llink = i;
-  int64_t p = nodes[i].ulink;
+  if (i <= last_bucketed_item) {
+    length_buckets.insert(i, len(i));
+  }
+  switch (option_width) {
+  case 2:
+    unhide_list<2>(i);
+    break;
+  case 3:
+    unhide_list<3>(i);
+    break;
+  case 4:
+    unhide_list<4>(i);
+    break;
+  case 5:
+    unhide_list<5>(i);
+    break;
+  case 6:
+    unhide_list<6>(i);
+    break;
+  default:
+    unhide_list<0>(i);
+  }
+}
+
+// hide_list() hides the options in the list of item i.
+template <typename Index>
+template <int K>
+void BasicExactCoverProblem<Index>::hide_list(Index i) {
+  Index p = nodes[i].dlink;
+  while (p != i) {
+    if constexpr (K == 0) {
+      hide(p);
+    } else {
+      hide_fixed<K>(p);
+    }
+    p = nodes[p].dlink;
+    ALGORITHM_X_COUNT(++stats.mems);
+  }
+}
+
+template <typename Index>
+template <int K>
+void BasicExactCoverProblem<Index>::unhide_list(Index i) {
+  Index p = nodes[i].ulink;
   while (p != i) {
-    unhide(p);
+    if constexpr (K == 0) {
+      unhide(p);
+    } else {
+      unhide_fixed<K>(p);
+    }
     p = nodes[p].ulink;
+    ALGORITHM_X_COUNT(++stats.mems);
   }
 }
 
-void ExactCoverProblem::hide(int64_t p) {
-  int64_t q = p + 1;
+/* hide() and unhide() are Knuth's hide' and unhide' from Algorithm C: nodes
+ * whose color has been set to -1 by purify() stay in their lists. Only the
+ * nodes of secondary items with colors can be purified, so no colors are read
+ * for items up to last_plain_item.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::hide(Index p) {
+  /* The links are read through a local pointer, which the compiler can keep
+   * in a register; it must otherwise assume that the stores below might change
+   * the vector's own pointer, and load that again at every step.
+   */
+  Node *node = nodes.data();
+  Index q = p + 1;
   while (q != p) {
-    int64_t x = nodes[q].top;
-    int64_t u = nodes[q].ulink;
-    int64_t d = nodes[q].dlink;
+    Index x = node[q].top;
     if (x <= 0) {
       // q was a spacer
-      q = u;
+      ALGORITHM_X_COUNT(stats.mems += 3);
+      q = node[q].ulink;
     } else {
-      nodes[u].dlink = d;
-      nodes[d].ulink = u;
-      // x has one less node.
-      ItemNode *item_x = (ItemNode *)&nodes[x];
-      --(item_x->len);
+      hide_node(node, q, x);
       ++q;
     }
   }
 }
 
-void ExactCoverProblem::unhide(int64_t p) {
-  int64_t q = p - 1;
+template <typename Index>
+void BasicExactCoverProblem<Index>::unhide(Index p) {
+  Node *node = nodes.data();
+  Index q = p - 1;
   while (q != p) {
-    int64_t x = nodes[q].top;
-    int64_t u = nodes[q].ulink;
-    int64_t d = nodes[q].dlink;
+    Index x = node[q].top;
     if (x <= 0) {
       // q was a spacer
-      q = d;
+      ALGORITHM_X_COUNT(stats.mems += 3);
+      q = node[q].dlink;
     } else {
-      nodes[u].dlink = q;
-      nodes[d].ulink = q;
-      // x has one more node.
-      ItemNode *item_x = (ItemNode *)&nodes[x];
-      ++(item_x->len);
+      unhide_node(node, q, x);
       --q;
     }
   }
 }
 
-void ExactCoverProblem::solve(bool find_all_solutions) {
-  if (!solved) {
-    algorithm_x(find_all_solutions);
-    solved = true;
+/* hide_fixed() and unhide_fixed() are hide() and unhide() for options that
+ * all have K items. The option of node p then begins at a node found by
+ * arithmetic, and its other nodes are visited in the same order, cycling
+ * round within its K nodes rather than through its spacer, so that no node
+ * need be tested for being a spacer and the loop can be unrolled.
+ */
+template <typename Index>
+template <int K>
+void BasicExactCoverProblem<Index>::hide_fixed(Index p) {
+  Node *node = nodes.data();
+  Index first = p - (p - option_base) % (K + 1);
+  for (int k = 1; k < K; ++k) {
+    Index q = p + k;
+    q = q < first + K ? q : q - K;
+    hide_node(node, q, node[q].top);
+  }
+}
+
+template <typename Index>
+template <int K>
+void BasicExactCoverProblem<Index>::unhide_fixed(Index p) {
+  Node *node = nodes.data();
+  Index first = p - (p - option_base) % (K + 1);
+  for (int k = 1; k < K; ++k) {
+    Index q = p - k;
+    q = q >= first ? q : q + K;
+    unhide_node(node, q, node[q].top);
+  }
+}
+
+// hide_node() takes node q, of item x, out of its list, unless it is purified.
+template <typename Index>
+inline void BasicExactCoverProblem<Index>::hide_node(Node *node, Index q,
+                                                     Index x) {
+  Index u = node[q].ulink;
+  Index d = node[q].dlink;
+  ALGORITHM_X_COUNT(stats.mems += 3);
+  ALGORITHM_X_COUNT(stats.mems += (x > last_plain_item));
+  if (x <= last_plain_item || node_colors[q] >= 0) {
+    ALGORITHM_X_COUNT(stats.mems += 3);
+    ALGORITHM_X_COUNT(++stats.updates);
+    node[u].dlink = d;
+    node[d].ulink = u;
+    // x has one less node.
+    --node[x].top;
+    if (x <= last_bucketed_item) {
+      length_buckets.shorten(x, node[x].top);
+    }
+  }
+}
+
+template <typename Index>
+inline void BasicExactCoverProblem<Index>::unhide_node(Node *node, Index q,
+                                                       Index x) {
+  Index u = node[q].ulink;
+  Index d = node[q].dlink;
+  ALGORITHM_X_COUNT(stats.mems += 3);
+  ALGORITHM_X_COUNT(stats.mems += (x > last_plain_item));
+  if (x <= last_plain_item || node_colors[q] >= 0) {
+    ALGORITHM_X_COUNT(stats.mems += 3);
+    node[u].dlink = q;
+    node[d].ulink = q;
+    // x has one more node.
+    ++node[x].top;
+    if (x <= last_bucketed_item) {
+      length_buckets.lengthen(x, node[x].top);
+    }
+  }
+}
+
+/* commit() and uncommit(), again from Algorithm C, deal with the item j of
+ * node p in an option being tried. An item with no color in that option is
+ * covered. A secondary item with a color is purified instead, which leaves it
+ * available to other options of the same color. A node whose color is -1
+ * belongs to an item that was already purified with that color, and needs
+ * nothing more.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::commit(Index p, Index j) {
+  if (j <= last_plain_item || node_colors[p] == 0) {
+    cover(j);
+  } else if (node_colors[p] > 0) {
+    purify(p);
+  }
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::uncommit(Index p, Index j) {
+  if (j <= last_plain_item || node_colors[p] == 0) {
+    uncover(j);
+  } else if (node_colors[p] > 0) {
+    unpurify(p);
+  }
+}
+
+/* purify() hides the options in which p's item has a color other than p's,
+ * and marks the nodes of the options which agree with it so that they will be
+ * left in place.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::purify(Index p) {
+  Index c = node_colors[p];
+  Index i = nodes[p].top;
+  Index q = nodes[i].dlink;
+  while (q != i) {
+    ALGORITHM_X_COUNT(stats.mems += 2);
+    if (node_colors[q] == c) {
+      node_colors[q] = -1;
+    } else {
+      hide(q);
+    }
+    q = nodes[q].dlink;
+  }
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::unpurify(Index p) {
+  Index c = node_colors[p];
+  Index i = nodes[p].top;
+  Index q = nodes[i].ulink;
+  while (q != i) {
+    ALGORITHM_X_COUNT(stats.mems += 2);
+    if (node_colors[q] < 0) {
+      node_colors[q] = c;
+    } else {
+      unhide(q);
+    }
+    q = nodes[q].ulink;
+  }
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::solve(bool find_all_solutions,
+                                          int64_t thread_count) {
+  if (thread_count < 1) {
+    throw std::invalid_argument("At least one thread is needed to solve.");
+  }
+  if (solved) {
+    return;
+  }
+  /* A search for a single solution stops at the first one found, and which
+   * one that is depends on the order in which the tree is explored. Only
+   * exhaustive searches are split across threads, so that the solutions
+   * reported are always those of the serial search.
+   */
+  search_nodes = 0;
+  ALGORITHM_X_COUNT(stats.clear());
+  ALGORITHM_X_TIME(stats.search_seconds);
+  start_limits();
+  // A search taken up from a checkpoint goes on with its solutions.
+  bool is_resumed = take_resumed_position();
+  if (!is_resumed) {
+    solutions.clear();
+  }
+  if (find_all_solutions && thread_count > 1 && !is_resumed) {
+    search_in_parallel(thread_count, true);
+  } else {
+    if (!is_resumed) {
+      start_serial_search();
+    }
+    while (resume_search()) {
+      append_solution();
+      if (!find_all_solutions) {
+        break;
+      }
+    }
+  }
+  // A search stopped by its limits may be run again.
+  solved = status == SearchStatus::complete;
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::solve_with(
+    const std::vector<int64_t> &assumptions, bool find_all_solutions) {
+  if (!bound.empty()) {
+    throw std::logic_error("Options cannot be assumed under multiplicities.");
+  }
+  search_nodes = 0;
+  ALGORITHM_X_COUNT(stats.clear());
+  ALGORITHM_X_TIME(stats.search_seconds);
+  start_limits();
+  solutions.clear();
+  if (assume(assumptions)) {
+    while (resume_search()) {
+      append_solution();
+      if (!find_all_solutions) {
+        break;
+      }
+    }
+  }
+  unwind();
+  search_state = SearchState::finished;
+  // The solutions are those of this query alone, so solve() is not spent.
+  solved = false;
+}
+
+/* assume() starts a search in which the given options have been chosen at
+ * the first levels, which are fixed, and the rest of the tree is yet to be
+ * entered. It returns false, having chosen nothing, if the options cannot
+ * all be in one solution.
+ */
+template <typename Index>
+bool BasicExactCoverProblem<Index>::assume(
+    const std::vector<int64_t> &assumptions) {
+  start_search();
+  if (option_starts.empty()) {
+    option_starts = option_first_nodes();
+  }
+  /* Each option is chosen through a node of a primary item, as the search
+   * would have chosen it. Two options conflict if they share an item, unless
+   * it is secondary and both give it the same color.
+   */
+  std::vector<Index> representatives;
+  std::vector<std::pair<Index, Index>> claims;
+  bool is_possible = true;
+  for (int64_t k : assumptions) {
+    if (k < 0 || k >= option_count()) {
+      throw std::invalid_argument("Assumed options must exist.");
+    }
+    Index representative = 0;
+    for (Index x = option_starts[k]; x < option_starts[k + 1] - 1; ++x) {
+      Index j = nodes[x].top;
+      Index c = node_colors.empty() ? 0 : node_colors[x];
+      if (j <= primary_count && representative == 0) {
+        representative = x;
+      }
+      // A color of -1 was purified by a forced option, and claims nothing.
+      if (c >= 0) {
+        claims.emplace_back(j, j <= primary_count ? 0 : c);
+      }
+    }
+    if (representative == 0) {
+      throw std::invalid_argument("Assumed options must contain a primary "
+                                  "item.");
+    }
+    // An option forced by preprocess() has been chosen already.
+    bool is_forced = false;
+    for (Index x : forced) {
+      is_forced = is_forced || option_of(x) == k;
+    }
+    if (is_forced) {
+      continue;
+    }
+    /* An option removed by preprocess(), or hidden by one that it forced,
+     * has left the list of its representative, or that list is covered.
+     */
+    Index i = nodes[representative].top;
+    is_possible = is_possible && items[items[i].llink].rlink == i &&
+                  nodes[nodes[representative].ulink].dlink == representative;
+    representatives.push_back(representative);
+  }
+  if (!is_possible) {
+    search_state = SearchState::finished;
+    return false;
+  }
+  std::sort(claims.begin(), claims.end());
+  for (int64_t m = 1; m < (int64_t)claims.size(); ++m) {
+    if (claims[m].first == claims[m - 1].first &&
+        (claims[m].second == 0 || claims[m].second != claims[m - 1].second)) {
+      search_state = SearchState::finished;
+      return false;
+    }
+  }
+  for (Index x : representatives) {
+    cover(nodes[x].top);
+    cover_other_items(x);
+    candidate.push_back(x);
+  }
+  root_level = candidate.size();
+  level = root_level;
+  return true;
+}
+
+/* count_solutions() runs an exhaustive search that only counts the solutions
+ * it reaches. Nothing is allocated once the search is under way, and the links
+ * are left as they were found, unless a limit stopped the search where
+ * checkpoint() can find it, so it can be called any number of times
+ * regardless of solve().
+ */
+template <typename Index>
+uint64_t
+BasicExactCoverProblem<Index>::count_solutions(int64_t thread_count) {
+  if (thread_count < 1) {
+    throw std::invalid_argument("At least one thread is needed to solve.");
+  }
+  search_nodes = 0;
+  ALGORITHM_X_COUNT(stats.clear());
+  ALGORITHM_X_TIME(stats.search_seconds);
+  start_limits();
+  bool is_resumed = take_resumed_position();
+  if (thread_count > 1 && !is_resumed) {
+    return search_in_parallel(thread_count, false);
+  }
+  uint64_t count = solutions_found;
+  if (!is_resumed) {
+    start_serial_search();
+  }
+  while (resume_search()) {
+    ++count;
+  }
+  if (status == SearchStatus::complete) {
+    unwind();
+  }
+  return count;
+}
+
+template <typename Index>
+typename BasicExactCoverProblem<Index>::SolutionRange
+BasicExactCoverProblem<Index>::enumerate() {
+  search_nodes = 0;
+  ALGORITHM_X_COUNT(stats.clear());
+  start_limits();
+  if (!take_resumed_position()) {
+    start_serial_search();
+  }
+  return SolutionRange{this};
+}
+
+template <typename Index>
+typename BasicExactCoverProblem<Index>::SolutionRange
+BasicExactCoverProblem<Index>::enumerate_with(
+    const std::vector<int64_t> &assumptions) {
+  if (!bound.empty()) {
+    throw std::logic_error("Options cannot be assumed under multiplicities.");
+  }
+  search_nodes = 0;
+  ALGORITHM_X_COUNT(stats.clear());
+  start_limits();
+  // If the options conflict, the search is already finished.
+  assume(assumptions);
+  return SolutionRange{this};
+}
+
+/* next_solution() advances the search to its next solution and lists the
+ * indices of the options in it, returning false if there are no more.
+ */
+template <typename Index>
+bool BasicExactCoverProblem<Index>::next_solution() {
+  ALGORITHM_X_TIME(stats.search_seconds);
+  if (!resume_search()) {
+    return false;
+  }
+  chosen_options.clear();
+  for (Index x : forced) {
+    chosen_options.push_back(option_of(x));
+  }
+  const std::vector<Index> &path =
+      search_engine == Backend::dancing_links ? candidate : engine_path;
+  for (Index x : path) {
+    // Under Algorithm M, a level may choose no option for its item.
+    if (x > primary_count) {
+      chosen_options.push_back(option_of(x));
+    }
+  }
+  return true;
+}
+
+/* option_of() returns the index of the option containing node x. The spacer
+ * preceding an option's nodes has a top the negative of which is that index.
+ */
+template <typename Index>
+int64_t BasicExactCoverProblem<Index>::option_of(Index x) const {
+  while (nodes[x].top > 0) {
+    --x;
+  }
+  return -nodes[x].top;
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::start_search() {
+  // Undo what is left of any earlier search that stopped part way.
+  unwind();
+  resume_pending = false;
+  // X1 (Initialize) is just the setting of l to 0.
+  root_level = 0;
+  level = 0;
+  search_state = SearchState::enter_level;
+  used_backend = Backend::dancing_links;
+}
+
+/* start_serial_search() starts a search on one thread from the root, by the
+ * links or by another engine; see choose_engine().
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::start_serial_search() {
+  start_search();
+  Backend engine = choose_engine();
+  if (engine != Backend::dancing_links) {
+    start_engine_search(engine);
+  }
+}
+
+/* take_resumed_position() returns true if a position loaded by resume() is
+ * waiting for the search being started, which then takes up its counts
+ * rather than starting afresh.
+ */
+template <typename Index>
+bool BasicExactCoverProblem<Index>::take_resumed_position() {
+  if (!resume_pending) {
+    return false;
+  }
+  resume_pending = false;
+  search_nodes = resume_nodes;
+  solutions_found = resume_solutions;
+  return true;
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::cover_other_items(Index x) {
+  switch (option_width) {
+  case 2:
+    return cover_fixed<2>(x);
+  case 3:
+    return cover_fixed<3>(x);
+  case 4:
+    return cover_fixed<4>(x);
+  case 5:
+    return cover_fixed<5>(x);
+  case 6:
+    return cover_fixed<6>(x);
+  }
+  Index p = x + 1;
+  while (p != x) {
+    Index j = nodes[p].top;
+    ALGORITHM_X_COUNT(stats.mems += 1 + (j <= 0));
+    if (j <= 0) {
+      // This is a spacer
+      p = nodes[p].ulink;
+    } else {
+      commit(p, j);
+      ++p;
+    }
+  }
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::uncover_other_items(Index x) {
+  switch (option_width) {
+  case 2:
+    return uncover_fixed<2>(x);
+  case 3:
+    return uncover_fixed<3>(x);
+  case 4:
+    return uncover_fixed<4>(x);
+  case 5:
+    return uncover_fixed<5>(x);
+  case 6:
+    return uncover_fixed<6>(x);
+  }
+  Index p = x - 1;
+  while (p != x) {
+    Index j = nodes[p].top;
+    ALGORITHM_X_COUNT(stats.mems += 1 + (j <= 0));
+    if (j <= 0) {
+      p = nodes[p].dlink;
+    } else {
+      uncommit(p, j);
+      --p;
+    }
+  }
+}
+
+// cover_fixed() and uncover_fixed() walk options of K items as hide_fixed().
+template <typename Index>
+template <int K>
+void BasicExactCoverProblem<Index>::cover_fixed(Index x) {
+  Index first = x - (x - option_base) % (K + 1);
+  for (int k = 1; k < K; ++k) {
+    Index p = x + k;
+    p = p < first + K ? p : p - K;
+    ALGORITHM_X_COUNT(++stats.mems);
+    commit(p, nodes[p].top);
+  }
+}
+
+template <typename Index>
+template <int K>
+void BasicExactCoverProblem<Index>::uncover_fixed(Index x) {
+  Index first = x - (x - option_base) % (K + 1);
+  for (int k = 1; k < K; ++k) {
+    Index p = x - k;
+    p = p >= first ? p : p + K;
+    ALGORITHM_X_COUNT(++stats.mems);
+    uncommit(p, nodes[p].top);
+  }
+}
+
+/* replay() brings the links to the state they are in when the search has
+ * chosen the options of the given nodes on levels 0, 1, ..., and it pushes
+ * those nodes onto the candidate stack. The last node is treated as x_l for a
+ * level l at which the search is to continue, so its item is covered but its
+ * option is left to step X5. All earlier levels are fixed: the search returns
+ * once it would backtrack into them.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::replay(const std::vector<Index> &prefix) {
+  start_search();
+  if (prefix.empty()) {
+    return;
+  }
+  Index last = prefix.size() - 1;
+  for (Index l = 0; l <= last; ++l) {
+    replay_level(prefix[l], l, l < last);
+  }
+  root_level = last;
+  level = last;
+  search_state = SearchState::try_option;
+}
+
+/* replay_level() re-enters level l, the levels below it having been replayed
+ * already, covering the item of node x and pushing x onto the candidate stack;
+ * if is_tried is set, it also tries the option of x, as in step X5.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::replay_level(Index x, Index l,
+                                                 bool is_tried) {
+  if (!bound.empty()) {
+    replay_level_with_bounds(x, l, is_tried);
+    return;
+  }
+  cover(nodes[x].top);
+  if (is_tried) {
+    cover_other_items(x);
+  }
+  candidate.push_back(x);
+}
+
+/* unwind() undoes the covering done at all levels still on the candidate stack,
+ * restoring the links to their initial state.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::unwind() {
+  if (search_engine != Backend::dancing_links) {
+    // The other engines left the links alone.
+    search_engine = Backend::dancing_links;
+    bitset_engine.clear();
+    dancing_cells.clear();
+  }
+  if (!bound.empty()) {
+    unwind_with_bounds();
+    return;
+  }
+  while (!candidate.empty()) {
+    uncover_other_items(candidate.back());
+    uncover(nodes[candidate.back()].top);
+    candidate.pop_back();
+  }
+}
+
+template <typename Index>
+bool BasicExactCoverProblem<Index>::resume_search() {
+  if (search_engine != Backend::dancing_links) {
+    return engine_search();
+  }
+  if (bound.empty()) {
+    return algorithm_x();
   }
+  return algorithm_m();
 }
 
-void ExactCoverProblem::algorithm_x(bool find_all_solutions) {
+template <typename Index>
+bool BasicExactCoverProblem<Index>::algorithm_x() {
   /*
    * This is an implementation of Donald Knuth's Algorithm X
    * as posed in _The Art of Computer Programming_,
    * volume 4, fascicle 5 (p. 67). It's a fairly straightforward
    * translation of the pseudocode into idiomatic C++. In particular, it
    * foregoes recursion, structured control flow or any inversions of the same.
+   *
+   * Rather than visiting solutions itself, the algorithm returns true whenever
+   * it reaches one, leaving the solution on the candidate stack. Calling it
+   * again resumes the search at X8. It returns false once the tree has been
+   * exhausted down to root_level, which is 0 unless a part of the tree is
+   * being searched on its own.
    */
+  Index l = level;
+  Index i;
 
-  /* X1
-   * Initialize.
-   */
-  // x1:
-  int64_t l = 0;
-  int64_t p;
-  int64_t j;
-  int64_t i;
-  goto x2;
+  switch (search_state) {
+  case SearchState::enter_level:
+    goto x2;
+  case SearchState::try_option:
+    i = nodes[candidate[l]].top;
+    goto x5;
+  case SearchState::leave_level:
+    goto x8;
+  case SearchState::finished:
+    return false;
+  }
 
   /* X2
    * Enter level l.
    */
 x2:
-  if (items[0].rlink == 0) {
-    // All items have been covered.
-    append_solution();
-
-    /*
-     * Here we deviate from Knuth. If find_all_solutions is false, then we
-     * return right now, having found a solution. Otherwise, we jump to X8, as
-     * in Knuth.
+  if (search_nodes >= next_check && !within_limits(l)) {
+    /* A limit was reached. End the search as if the tree were exhausted, but
+     * keep its position for checkpoint().
      */
-    if (!find_all_solutions)
-      return;
-
-    goto x8;
+    level = l;
+    search_state = SearchState::enter_level;
+    return false;
+  }
+  ++search_nodes;
+  ALGORITHM_X_COUNT(stats.count_node(l));
+  ALGORITHM_X_COUNT(++stats.mems);
+  if (items[0].rlink == 0) {
+    // All items have been covered. Visit the solution, then resume at X8.
+    ALGORITHM_X_COUNT(++stats.solutions);
+    ++solutions_found;
+    if (limits.solutions > 0) {
+      next_check = search_nodes;
+    }
+    level = l;
+    search_state = SearchState::leave_level;
+    return true;
+  }
+  if (work_queue != nullptr) {
+    // Give away untried options if another thread is waiting for work.
+    share_work(l);
   }
 
   /* X3
@@ -335,6 +1199,7 @@ x2:
   // x4:
   cover(i);
   candidate.push_back(nodes[i].dlink);
+  ALGORITHM_X_COUNT(++stats.mems);
   goto x5;
 
   /* X5
@@ -345,19 +1210,10 @@ x5:
     /* We've tried all options for i to no avail. We must backtrack. */
     goto x7;
   } else {
-    p = candidate[l] + 1;
-    while (p != candidate[l]) {
-      j = nodes[p].top;
-
-      if (j <= 0) {
-        // This is a spacer
-        p = nodes[p].ulink;
-      } else {
-        // Cover the items != i in the option that contains x + l.
-        cover(j);
-        ++p;
-      }
-    }
+    /* Cover the items != i in the option that contains x_l, or purify those
+     * given colors, as in Algorithm C.
+     */
+    cover_other_items(candidate[l]);
     // Now increment l and deepen a level.
     ++l;
     goto x2;
@@ -367,18 +1223,10 @@ x5:
    * Try again.
    */
 x6:
-  p = candidate[l] - 1;
-  while (p != candidate[l]) {
-    j = nodes[p].top;
-    if (j <= 0) {
-      p = nodes[p].dlink;
-    } else {
-      uncover(j);
-      --p;
-    }
-  }
+  uncover_other_items(candidate[l]);
   i = nodes[candidate[l]].top;
   candidate[l] = nodes[candidate[l]].dlink;
+  ALGORITHM_X_COUNT(stats.mems += 2);
   goto x5;
 
   /* X7
@@ -386,77 +1234,106 @@ x6:
    */
 x7:
   uncover(i);
+  candidate.pop_back();
 
   /* X8
    * Exit level l.
    */
 x8:
-  if (l == 0) {
-    return;
+  if (l == root_level) {
+    level = l;
+    search_state = SearchState::finished;
+    return false;
   }
-  candidate.pop_back();
   --l;
   goto x6;
 }
 
-/* append_solution() stores a vector of strings, each representing an option
- * chosen in the solution. Each option is represented in accordance with
- * exercise 12 (p. 123), where the representation is rotated to the left such
- * that the item that led to that option being chosen is printed first. For
- * instance, if the item "d" led to the option "adf" being chosen, this choice
- * would be represented as "dfa".
+/* append_solution() stores the options chosen in the solution, by index,
+ * each with the position of its representative item, the one that led to the
+ * option being chosen. Its items are only written out from the links when
+ * asked for; see led_option().
  */
-void ExactCoverProblem::append_solution() {
-  solutions.push_back({});
-  std::vector<std::vector<int64_t>> &solution = solutions.back();
-
-  for (int64_t rep_index : candidate) {
-    /* Get the index of the item this representative refers to so we
-     * can find the item that led to this choice of option. */
-    int64_t item_index = nodes[rep_index].top;
-    Item *item = (Item *)&nodes[item_index];
-    int64_t item_name = item->name;
-
-    /* The first spacer to follow this node will have a top the negative of
-     * which is the index of the first option in the representation. Find it by
-     * incrementing rep_index until the spacer is found.
-     */
-    while (nodes[rep_index].top > 0) {
-      --rep_index;
+template <typename Index>
+void BasicExactCoverProblem<Index>::append_solution() {
+  ALGORITHM_X_TIME(stats.record_seconds);
+  // The options forced by preprocess() come before those of the search.
+  const std::vector<Index> &path =
+      search_engine == Backend::dancing_links ? candidate : engine_path;
+  for (int64_t k = 0; k < (int64_t)(forced.size() + path.size()); ++k) {
+    Index rep_index =
+        k < (int64_t)forced.size() ? forced[k] : path[k - forced.size()];
+    if (rep_index <= primary_count) {
+      // This level chose no option, under Algorithm M.
+      continue;
     }
-
-    int64_t option_index = -(nodes[rep_index].top);
-    std::vector<int64_t> *option_name = &options_description[option_index];
-
-    // We write out the option as led by the representative item into
-    // option_rep.
-    std::vector<int64_t> option_rep{};
-    int64_t offset = 0; /* the offset represents the index of the representative
-                           item in the original option representation */
-    for (int64_t option_item : *option_name) {
-      if (option_item == item_name) {
-        break;
-      }
-      ++offset;
+    Index first = rep_index;
+    while (nodes[first - 1].top > 0) {
+      --first;
     }
-    /* Having found the offset, cycle through the original option representation
-     * starting with the representative item. */
-    int64_t option_size = option_name->size();
-    for (int64_t i = 0; i < option_size; ++i) {
-      int64_t item = (*option_name)[(i + offset) % option_size];
-      option_rep.push_back(item);
+    solutions.add_option(-nodes[first - 1].top, rep_index - first);
+  }
+  solutions.end_solution();
+}
+
+/* option_first_nodes() lists the first node of each option, and the spacer
+ * after the last one.
+ */
+template <typename Index>
+std::vector<Index> BasicExactCoverProblem<Index>::option_first_nodes() const {
+  std::vector<Index> starts;
+  starts.reserve(option_count() + 1);
+  for (Index x = items_description.size() + 1; x < (Index)nodes.size(); ++x) {
+    if (nodes[x].top <= 0) {
+      starts.push_back(x + 1);
     }
-    solution.push_back(std::move(option_rep));
   }
+  return starts;
+}
+
+/* led_option() writes out the items of the option whose nodes begin at first
+ * in accordance with exercise 12 (p. 123): the representation is rotated to
+ * the left such that the item at node lead, which led to that option being
+ * chosen, is printed first. For instance, if the item "d" led to the option
+ * "adf" being chosen, this choice would be represented as "dfa". The option
+ * is read back from its nodes, which lie between two spacers in the order in
+ * which its items were given, so that it needs no description.
+ */
+template <typename Index>
+std::vector<int64_t>
+BasicExactCoverProblem<Index>::led_option(Index first, Index lead) const {
+  Index last = lead;
+  while (nodes[last + 1].top > 0) {
+    ++last;
+  }
+  std::vector<int64_t> option_rep;
+  option_rep.reserve(last - first + 1);
+  for (Index x = lead; x <= last; ++x) {
+    option_rep.push_back(items_description[nodes[x].top - 1]);
+  }
+  for (Index x = first; x < lead; ++x) {
+    option_rep.push_back(items_description[nodes[x].top - 1]);
+  }
+  return option_rep;
 }
 
+template <typename Index>
 const std::string
-ExactCoverProblem::option_str(const std::vector<int64_t> &option) const {
+BasicExactCoverProblem<Index>::option_str(
+    const std::vector<int64_t> &option) const {
   std::stringstream ss;
   if (has_string_description) {
     for (int64_t i : option) {
       ss << (char)i;
     }
+  } else if (!item_names.empty()) {
+    // Items read from a DLX file are named as they were there.
+    for (int64_t i = 0; i < (int64_t)option.size(); ++i) {
+      if (i > 0) {
+        ss << ' ';
+      }
+      ss << item_names[option[i] - 1];
+    }
   } else {
     for (int64_t i = 0; i < (int64_t)option.size(); ++i) {
       if (i > 0) {
@@ -469,41 +1346,52 @@ ExactCoverProblem::option_str(const std::vector<int64_t> &option) const {
   return ss.str();
 }
 
-const std::vector<std::vector<std::vector<int64_t>>> &
-ExactCoverProblem::get_solutions() const {
-  return solutions;
+template <typename Index>
+std::vector<std::vector<std::vector<int64_t>>>
+BasicExactCoverProblem<Index>::get_solutions() const {
+  std::vector<Index> starts = option_first_nodes();
+  std::vector<std::vector<std::vector<int64_t>>> rebuilt(solutions.size());
+  for (int64_t k = 0; k < solutions.size(); ++k) {
+    const int64_t *options = solutions.options(k);
+    const int32_t *leads = solutions.leads(k);
+    rebuilt[k].reserve(solutions.length(k));
+    for (int64_t m = 0; m < solutions.length(k); ++m) {
+      Index first = starts[options[m]];
+      rebuilt[k].push_back(led_option(first, first + leads[m]));
+    }
+  }
+  return rebuilt;
 }
 
-const std::string ExactCoverProblem::solutions_string() const {
+template <typename Index>
+const std::string BasicExactCoverProblem<Index>::solutions_string() const {
   // Exit early for an empty solutions vector.
-  if (solutions.size() == 0) {
+  if (solutions.empty()) {
     return ("The solution set is empty. "
             "Either it has no solution, "
             "or you never invoked solve().");
   }
 
+  std::vector<Index> starts = option_first_nodes();
   std::basic_stringstream<char> ss;
-  /* We will comma separate solutions and the options in each solution. Indices
-   * are used to track these.
-   */
-  int64_t i = 0;
-  for (const std::vector<std::vector<int64_t>> &solution_vec : solutions) {
+  // We will comma separate solutions and the options in each solution.
+  for (int64_t k = 0; k < solutions.size(); ++k) {
     // If this isn't the first solution, add a comma to separate it.
-    if (i > 0) {
+    if (k > 0) {
       ss << ", ";
     }
     ss << "{";
-    int64_t j = 0;
-    for (const std::vector<int64_t> &option : solution_vec) {
+    const int64_t *options = solutions.options(k);
+    const int32_t *leads = solutions.leads(k);
+    for (int64_t m = 0; m < solutions.length(k); ++m) {
       // If this isn't the first option, add a comma to separate it.
-      if (j > 0) {
+      if (m > 0) {
         ss << ", ";
       }
-      ss << option_str(option);
-      ++j;
+      Index first = starts[options[m]];
+      ss << option_str(led_option(first, first + leads[m]));
     }
     ss << "}";
-    ++i;
   }
   return ss.str();
 }
@@ -512,27 +1400,60 @@ const std::string ExactCoverProblem::solutions_string() const {
  * For this implementation, we use the MRV (minimum remaining values) heuristic
  * from exercise 9 (p. 123).
  */
-int64_t ExactCoverProblem::choose_item_to_cover() {
-  int64_t shortest = INT64_MAX; // Start at the top of the lattice.
-  int64_t shortest_index = -1;
-  int64_t i = items[0].rlink;
+template <typename Index>
+Index BasicExactCoverProblem<Index>::choose_item_to_cover() {
+  if (has_length_buckets) {
+    int64_t shortest_index = length_buckets.first_shortest();
+    if (shortest_index >= 0) {
+      return shortest_index;
+    }
+    // Otherwise every list is too long to be bucketed. Fall back on the scan.
+  }
+  // Start at the top of the lattice.
+  Index shortest = std::numeric_limits<Index>::max();
+  Index shortest_index = -1;
+  Index i = items[0].rlink;
   while (i != 0) {
-    ItemNode *item_node = (ItemNode *)&nodes[i];
-    if (item_node->len < shortest) {
-      shortest = item_node->len;
+    ALGORITHM_X_COUNT(stats.mems += 2);
+    if (len(i) < shortest) {
+      shortest = len(i);
       shortest_index = i;
+      if (shortest == 0) {
+        // Nothing comes before an empty list.
+        break;
+      }
     }
     i = items[i].rlink;
   }
   return shortest_index;
 }
 
+template <typename Index>
+void BasicExactCoverProblem<Index>::use_length_buckets(bool enabled) {
+  has_length_buckets = enabled && bound.empty();
+  // Only primary items are ever chosen, so only they are bucketed.
+  last_bucketed_item = has_length_buckets ? primary_count : 0;
+  if (has_length_buckets) {
+    // Sort whatever items are active now.
+    length_buckets.reset(items.size());
+    for (Index i = items[0].rlink; i != 0; i = items[i].rlink) {
+      length_buckets.insert(i, len(i));
+    }
+  }
+}
+
 /* This method outputs a table formatted like Table 1 in The Art of Computer
  * Programming, volume 4, fascicle 5 (p. 66). It's useful both for debugging and
  * for better understanding the functioning of the algorithm. */
-const std::string ExactCoverProblem::to_aocp_table() const {
+template <typename Index>
+const std::string BasicExactCoverProblem<Index>::to_aocp_table() const {
   std::basic_stringstream<char> ss;
-  int64_t item_count = items.size();
+  /* As in Table 2 (p. 73), the header of the secondary items is shown only if
+   * there are any.
+   */
+  bool has_secondary_items =
+      primary_count < (Index)items_description.size();
+  int64_t item_count = items.size() - (has_secondary_items ? 0 : 1);
   int64_t node_count = nodes.size();
   ss << "Items: " << item_count << "\n";
   ss << "Nodes: " << node_count << "\n";
@@ -545,34 +1466,39 @@ const std::string ExactCoverProblem::to_aocp_table() const {
 
   ss << "NAME(i):"
      << "\t";
-  int64_t i = 0;
-  for (const Item &item : items) {
-    // The first item slot is always null.
-    // Don't output it as a character.
-    if (has_string_description && i > 0) {
-      ss << char(item.name) << "\t";
+  // The first item slot is always null.
+  ss << 0 << "\t";
+  for (int64_t name : items_description) {
+    if (has_string_description) {
+      ss << char(name) << "\t";
+    } else if (!item_names.empty()) {
+      ss << item_names[name - 1] << "\t";
     } else {
-      ss << item.name << "\t";
+      ss << name << "\t";
     }
-    ++i;
+  }
+  if (has_secondary_items) {
+    ss << 0 << "\t";
   }
   ss << "\n";
 
   ss << "LLINK(i):"
      << "\t";
-  for (const Item &item : items) {
-    ss << item.llink << "\t";
+  for (int64_t i = 0; i < item_count; ++i) {
+    ss << items[i].llink << "\t";
   }
   ss << "\n";
 
   ss << "RLINK(i):"
      << "\t";
-  for (const Item &item : items) {
-    ss << item.rlink << "\t";
+  for (int64_t i = 0; i < item_count; ++i) {
+    ss << items[i].rlink << "\t";
   }
   ss << "\n";
 
-  int64_t row_count = ((node_count - 1) / item_count) + 1;
+  // The nodes are laid out in rows as wide as the item headers.
+  int64_t row_width = items_description.size() + 1;
+  int64_t row_count = ((node_count - 1) / row_width) + 1;
   for (int64_t row = 0; row < row_count; ++row) {
     /*
      * The bound determines how many nodes to place in the row.
@@ -580,15 +1506,15 @@ const std::string ExactCoverProblem::to_aocp_table() const {
      * incomplete. If the last row is incomplete, it is just those nodes
      * remaining.
      */
-    int64_t bound = item_count;
-    if (row == (row_count - 1) && node_count % item_count) {
-      bound = node_count % item_count;
+    int64_t bound = row_width;
+    if (row == (row_count - 1) && node_count % row_width) {
+      bound = node_count % row_width;
     }
 
     ss << "x:"
        << "\t\t";
     for (int64_t i = 0; i < bound; ++i) {
-      int64_t x = i + (row * item_count);
+      int64_t x = i + (row * row_width);
       ss << x << "\t";
     }
     ss << "\n";
@@ -597,24 +1523,37 @@ const std::string ExactCoverProblem::to_aocp_table() const {
       ss << "LEN(x):"
          << "\t\t";
       for (int64_t i = 0; i < bound; ++i) {
-        int64_t x = i + (row * item_count);
-        ItemNode *item_node = (ItemNode *)&nodes[x];
-        ss << item_node->len << "\t";
+        int64_t x = i + (row * row_width);
+        ss << nodes[x].top << "\t";
       }
     } else {
       ss << "TOP(x):"
          << "\t\t";
       for (int64_t i = 0; i < bound; ++i) {
-        int64_t x = i + (row * item_count);
+        int64_t x = i + (row * row_width);
         ss << nodes[x].top << "\t";
       }
     }
     ss << "\n";
 
+    if (row > 0 && !node_colors.empty()) {
+      ss << "COLOR(x):"
+         << "\t";
+      for (int64_t i = 0; i < bound; ++i) {
+        int64_t x = i + (row * row_width);
+        if (has_string_description && node_colors[x] > 0) {
+          ss << char(node_colors[x]) << "\t";
+        } else {
+          ss << node_colors[x] << "\t";
+        }
+      }
+      ss << "\n";
+    }
+
     ss << "ULINK(x):"
        << "\t";
     for (int64_t i = 0; i < bound; ++i) {
-      int64_t x = i + (row * item_count);
+      int64_t x = i + (row * row_width);
       ss << nodes[x].ulink << "\t";
     }
     ss << "\n";
@@ -622,7 +1561,7 @@ const std::string ExactCoverProblem::to_aocp_table() const {
     ss << "DLINK(x):"
        << "\t";
     for (int64_t i = 0; i < bound; ++i) {
-      int64_t x = i + (row * item_count);
+      int64_t x = i + (row * row_width);
       ss << nodes[x].dlink << "\t";
     }
     ss << "\n";
@@ -630,4 +1569,7 @@ const std::string ExactCoverProblem::to_aocp_table() const {
   return ss.str();
 }
 
+template class BasicExactCoverProblem<int32_t>;
+template class BasicExactCoverProblem<int64_t>;
+
 } // namespace algorithm_x
@@ -1,64 +1,405 @@
 #ifndef ALGORITHM_X_H
 #define ALGORITHM_X_H
 
+#include "backend.h"
+#include "bitset_engine.h"
+#include "dancing_cells.h"
+#include "job_shards.h"
+#include "length_buckets.h"
+#include "preprocessing.h"
+#include "search_limits.h"
+#include "search_statistics.h"
+#include "solution_store.h"
+#include "tree_size_estimate.h"
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace algorithm_x {
 
-class ExactCoverProblem {
+class Zdd;
+template <typename Index> class BasicExactCoverBuilder;
+
+/* A SolutionView presents a solution as the indices of its options, in the
+ * order in which the options were given, without copying them. It is only
+ * valid until the search moves on to the next solution.
+ */
+class SolutionView {
+public:
+  using const_iterator = std::vector<int64_t>::const_iterator;
+
+  SolutionView() : options(nullptr) {}
+  explicit SolutionView(const std::vector<int64_t> &options)
+      : options(&options) {}
+
+  int64_t size() const { return options->size(); }
+  int64_t operator[](int64_t k) const { return (*options)[k]; }
+  const_iterator begin() const { return options->begin(); }
+  const_iterator end() const { return options->end(); }
+
+private:
+  const std::vector<int64_t> *options;
+};
+
+/* BasicExactCoverProblem is parameterized on the signed integer type used for
+ * the links between items and nodes. Every node holds three of them, so the
+ * width of Index sets the memory traffic of the search; a 32-bit Index halves
+ * it, and suffices for any instance of fewer than 2^31 nodes. Index must be
+ * signed because spacers are marked by tops that are not positive.
+ *
+ * ExactCoverProblem, with 64-bit links, can hold any instance;
+ * CompactExactCoverProblem, with 32-bit links, is faster where it fits.
+ */
+template <typename Index> class BasicExactCoverProblem {
+  static_assert(std::is_integral<Index>::value && std::is_signed<Index>::value,
+                "Links must have a signed integral type.");
+
 public:
-  ExactCoverProblem(std::string i, std::vector<std::string> o);
-  ExactCoverProblem(std::vector<int64_t> i,
-                    std::vector<std::vector<int64_t>> o);
-  ExactCoverProblem(ExactCoverProblem &other);
-  ExactCoverProblem(ExactCoverProblem &&other);
-  ExactCoverProblem &operator=(ExactCoverProblem &other);
-  ExactCoverProblem &operator=(ExactCoverProblem &&other);
-  ~ExactCoverProblem();
-
-  void solve(bool find_all_solutions = true);
+  class SolutionRange;
+
+  BasicExactCoverProblem(std::string i, std::vector<std::string> o);
+  BasicExactCoverProblem(std::vector<int64_t> i,
+                         std::vector<std::vector<int64_t>> o);
+  /* Secondary items, as in Knuth's Algorithm C, may be covered at most once
+   * rather than exactly once. They may also be given colors in each option:
+   * then any number of options can share a secondary item so long as they
+   * give it the same color. In the string form, a colon and a character
+   * after an item in an option give it that color, e.g. "pqx:A". In the
+   * integer form, colors[k][m] is the color of the m-th item of option k, and
+   * 0 means no color. Items may be listed in options in any order, but each
+   * must be known and appear at most once in an option.
+   */
+  BasicExactCoverProblem(std::string primary, std::string secondary,
+                         std::vector<std::string> o);
+  BasicExactCoverProblem(std::vector<int64_t> primary,
+                         std::vector<int64_t> secondary,
+                         std::vector<std::vector<int64_t>> o,
+                         std::vector<std::vector<int64_t>> colors = {});
+  BasicExactCoverProblem(BasicExactCoverProblem &other);
+  BasicExactCoverProblem(BasicExactCoverProblem &&other);
+  BasicExactCoverProblem &operator=(BasicExactCoverProblem &other);
+  BasicExactCoverProblem &operator=(BasicExactCoverProblem &&other);
+  ~BasicExactCoverProblem();
+
+  /* read_dlx() loads a problem written in the text format of Knuth's DLX
+   * programs. The first line that is not a comment (comments begin with '|')
+   * names the items, with a lone '|' between the primary and the secondary
+   * ones; each line after it is an option, listing its items in any order. As
+   * in DLX2, a secondary item may be given a color after a colon, e.g. "x:red",
+   * and as in DLX3, a primary item may be preceded by its multiplicities,
+   * "u:v|a" or "v|a". The file is mapped into memory and parsed in one pass.
+   */
+  static BasicExactCoverProblem read_dlx(const std::string &path);
+  /* write_snapshot() saves the problem with its links fully set up, and
+   * read_snapshot() loads it again without parsing or linking anything, so
+   * long as the width of the links and the byte order are the same. Writing a
+   * snapshot abandons any search under way.
+   */
+  void write_snapshot(const std::string &path);
+  static BasicExactCoverProblem read_snapshot(const std::string &path);
+
+  /* preprocess() shrinks the problem before it is searched, repeating until
+   * nothing changes: an item left with a single option forces that option,
+   * which is chosen once and for all, hiding the options that clash with it;
+   * and an option is removed if choosing it would leave some item with no
+   * options, as in Knuth's DLX-PRE. If keep_all_solutions is false, an option
+   * is also removed if another has the same primary items and claims only
+   * some of its secondary items; a duplicate, the later of two equal options,
+   * is dominated in the same way. Every solution then still stands for one of
+   * the problem as given, and one is found if there were any, but others
+   * that differ only in such options are not.
+   *
+   * The options keep their indices, and the forced ones are listed first in
+   * every solution. Multiplicities are not supported.
+   */
+  PreprocessingReport preprocess(bool keep_all_solutions = true);
+  /* break_symmetry() takes a symmetry of the problem, given by the image of
+   * each option, which must be an involution mapping solutions to solutions,
+   * and halves the search by Knuth's trick for Langford pairs: it finds a
+   * primary item whose options are swapped in pairs among themselves, the
+   * shortest if there are several, and removes the later option of each pair.
+   * Every solution S then has exactly one of S and its image left, so the
+   * solutions found, together with their images, are all of the solutions,
+   * none of them twice. It returns false, changing nothing, if no item will
+   * do. It must be called before preprocess(), and at most once.
+   */
+  bool break_symmetry(const std::vector<int64_t> &image);
+  /* solve() searches for a single solution or for all of them. An exhaustive
+   * search can be split across thread_count threads; the solutions found are
+   * the same, and in the same order, as those of a search on one thread.
+   */
+  void solve(bool find_all_solutions = true, int64_t thread_count = 1);
+  /* solve_with() finds the solutions that include all of the given options,
+   * by choosing them before the search begins, and then restores the links
+   * so that the problem can be asked again with other options. Each option
+   * must contain a primary item, and multiplicities are not supported. The
+   * solutions replace any stored before, and list the given options first,
+   * after any forced by preprocess().
+   */
+  void solve_with(const std::vector<int64_t> &assumptions,
+                  bool find_all_solutions = true);
+  /* count_solutions() returns the number of solutions without storing any of
+   * them.
+   */
+  uint64_t count_solutions(int64_t thread_count = 1);
+  /* enumerate() starts a new search whose solutions are produced one at a time
+   * as the returned range is iterated, e.g.
+   *   for (const SolutionView &solution : problem.enumerate()) { ... }
+   * The search only advances as far as the loop asks it to, and no solutions
+   * are stored. Starting any other search abandons it.
+   */
+  SolutionRange enumerate();
+  /* enumerate_with() is to enumerate() as solve_with() is to solve(): it
+   * produces the solutions that include the given options, which are listed
+   * in each. The options stay chosen until the next search is started.
+   */
+  SolutionRange enumerate_with(const std::vector<int64_t> &assumptions);
+  /* set_search_limits() bounds every search started from then on by solve(),
+   * solve_with(), count_solutions() or enumerate(), with budgets of time,
+   * nodes and solutions, a token by which another thread can cancel it, and a
+   * callback to report its progress; see search_limits.h. search_status()
+   * tells how the last of them ended. A search that was stopped leaves the
+   * solutions it found, and its position, which checkpoint() can save;
+   * solve() may then be called again to search afresh.
+   */
+  void set_search_limits(SearchLimits search_limits);
+  SearchStatus search_status() const { return status; }
+  /* checkpoint() saves the position of the search under way on one thread,
+   * paused at a solution of enumerate() or stopped by its limits, to a file:
+   * the options chosen at each level, the counts of nodes and solutions, and
+   * the solutions stored by solve(). resume() loads such a file into a problem
+   * set up just as the one that wrote it, re-covering the items of those
+   * options to rebuild the links. The next search started by solve(),
+   * count_solutions() or enumerate(), which should be of the same kind as the
+   * one saved, then carries on from there on one thread, without visiting any
+   * node twice, and its counts include those made before the checkpoint.
+   * Searches can also write checkpoints as they go; see SearchLimits.
+   */
+  void checkpoint(const std::string &path);
+  void resume(const std::string &path);
+  /* write_jobs() splits an exhaustive search into jobs that separate
+   * processes can run without sharing anything, on one machine or many. It
+   * searches the first depth levels of the tree, and lists in a text file, as
+   * a job, each node it reaches at that depth, and each solution above it, by
+   * the options chosen on the way there. It returns the number of jobs.
+   *
+   * load_job() sets up the links of a problem made just as the one that wrote
+   * the jobs, so that the next search started by solve(), count_solutions()
+   * or enumerate() explores the subtree of the given job alone, on one
+   * thread. run_job() runs the job in this way and writes its counts, and
+   * its solutions if list_solutions is set, to a result file; see
+   * merge_job_results() in job_shards.h. Multiplicities are not supported.
+   */
+  int64_t write_jobs(const std::string &path, int64_t depth);
+  void load_job(const std::string &path, int64_t job);
+  uint64_t run_job(const std::string &jobs_path, int64_t job,
+                   const std::string &result_path, bool list_solutions = true);
+  /* estimate_tree_size() estimates the size of the tree an exhaustive search
+   * would explore, from the given number of random probes, each a walk from
+   * the root to a leaf that takes time in proportion to the depth of the tree
+   * rather than its size; see tree_size_estimate.h. The same seed gives the
+   * same estimate. Multiplicities are not supported.
+   */
+  TreeSizeEstimate estimate_tree_size(int64_t samples, uint64_t seed = 0);
+  /* search_node_count() is the number of nodes of the search tree, that is,
+   * the number of times a level was entered, in the last search started by
+   * solve(), count_solutions() or enumerate(), or in build_zdd().
+   */
+  uint64_t search_node_count() const { return search_nodes; }
+  /* statistics() gives the counts and times of the last search, as described
+   * in search_statistics.h. They are gathered only in builds that define
+   * ALGORITHM_X_STATS, and are zero otherwise.
+   */
+  const SearchStatistics &statistics() const { return stats; }
+  /* use_length_buckets() switches the choice of items between a scan of all
+   * active items and a lookup in LengthBuckets, which must then be kept up to
+   * date as lists shrink and grow. Both choose the same items. The lookup is
+   * used by default for problems of at least length_bucket_threshold items,
+   * unless set_multiplicities() has been called.
+   */
+  void use_length_buckets(bool enabled);
+  /* set_multiplicities() asks that primary item i be covered at least
+   * lower[i - 1] and at most upper[i - 1] times, rather than exactly once, as
+   * in Knuth's Algorithm M. Then 0 <= u <= v and v > 0 for each item. The
+   * search branches on the item with the fewest ways to branch, and length
+   * buckets are not used, since lengths alone no longer tell which that is.
+   */
+  void set_multiplicities(std::vector<int64_t> lower,
+                          std::vector<int64_t> upper);
+  /* use_backend() chooses the engine that runs the searches of solve(),
+   * count_solutions() and enumerate() on one thread: the dancing links, the
+   * bitset engine of bitset_engine.h, or the dancing cells of
+   * dancing_cells.h. All of them visit the same number of nodes and find the
+   * same solutions, and all but the dancing cells find them in the same
+   * order. Neither of the others takes colors, multiplicities or search
+   * limits, and the dancing links run any search they cannot, as they do
+   * the rest of the searches. The bitset engine is used by default when
+   * the number of primary items times the number of 64-bit words in a bitset
+   * of the options is at most bitset_size_limit, past which counting the
+   * options of every item at every node costs more than the links save, and
+   * not in builds that gather statistics. search_backend() tells which
+   * engine ran the last search.
+   */
+  void use_backend(Backend chosen);
+  Backend search_backend() const { return used_backend; }
+  /* build_zdd() runs Knuth's Algorithm Z, which remembers each subproblem by
+   * the set of items still active and solves it only once, and returns all of
+   * the solutions as a Zdd (see zdd.h), from which they can be counted or
+   * streamed. The memos are dropped whenever they would take more than about
+   * cache_bytes, which costs time but not correctness. Colors and
+   * multiplicities are not supported.
+   */
+  Zdd build_zdd(int64_t cache_bytes = default_zdd_cache_bytes);
+  static const int64_t default_zdd_cache_bytes = int64_t(1) << 28;
+  static const int64_t length_bucket_threshold = 512;
+  static const int64_t bitset_size_limit = 2304;
   const std::string solutions_string() const;
   const std::string to_aocp_table() const;
 
-  const std::vector<std::vector<std::vector<int64_t>>> &get_solutions() const;
+  /* get_solutions() rebuilds the solutions stored by solve() as lists of the
+   * items of their options, each led by the item through which the option
+   * was chosen, after exercise 12 (p. 123). stored_solutions() gives them as
+   * they are kept, by the indices of their options, and write_solutions()
+   * streams those indices to a file descriptor; see solution_store.h.
+   */
+  std::vector<std::vector<std::vector<int64_t>>> get_solutions() const;
+  const SolutionStore &stored_solutions() const { return solutions; }
+  void write_solutions(int fd,
+                       SolutionFormat format = SolutionFormat::varint) const {
+    solutions.write(fd, format);
+  }
 
 private:
-  struct Item {
-    int64_t name;
-    int64_t llink;
-    int64_t rlink;
-  };
+  friend class BasicExactCoverBuilder<Index>;
 
-  struct ItemNode {
-    int64_t len;
-    int64_t ulink;
-    int64_t dlink;
+  /* Items only hold the links of the list of active items. The name of item i
+   * is kept apart, as items_description[i - 1], since the search never reads
+   * it.
+   */
+  struct Item {
+    Index llink;
+    Index rlink;
   };
 
+  /* The first nodes head the lists of the items, and for these top holds the
+   * length of the list instead; see len().
+   */
   struct Node {
-    int64_t top;
-    int64_t ulink;
-    int64_t dlink;
+    Index top;
+    Index ulink;
+    Index dlink;
   };
 
+  /* SearchState records the step at which algorithm_x() resumes the search
+   * when it is next called.
+   */
+  enum class SearchState { enter_level, try_option, leave_level, finished };
+
+  // WorkQueue holds the subtrees waiting to be searched by a pool of threads.
+  struct WorkQueue;
+
+  // The readers of files fill in an empty problem.
+  BasicExactCoverProblem();
+
   void initialize_problem();
+  void initialize_search();
+  void initialize_colors();
   void initialize_items();
   void initialize_nodes();
 
-  void place_spacer(int64_t node_index, int64_t option_index);
-  void place_node(int64_t node_index, int64_t item_index);
-  int64_t choose_item_to_cover();
-  void algorithm_x(bool find_all_solutions);
+  // len(i) is LEN(i), the number of active options that contain item i.
+  Index &len(Index i) { return nodes[i].top; }
+  /* option_count() is the number of options, read from the top of the last
+   * spacer, since options_description may have been dropped.
+   */
+  int64_t option_count() const { return -nodes.back().top; }
+
+  void place_spacer(Index node_index, Index option_index);
+  void place_node(Index node_index, Index item_index);
+  Index choose_item_to_cover();
+  void start_search();
+  void start_serial_search();
+  bool take_resumed_position();
+  uint64_t fingerprint() const;
+  bool assume(const std::vector<int64_t> &assumptions);
+  void replay(const std::vector<Index> &prefix);
+  void replay_level(Index x, Index l, bool is_tried);
+  void unwind();
+  /* resume_search() runs another engine if it holds the search, else
+   * Algorithm M if there are multiplicities, else X.
+   */
+  bool resume_search();
+  bool algorithm_x();
+  bool algorithm_m();
+  bool next_solution();
+  int64_t option_of(Index x) const;
+  std::vector<Index> option_first_nodes() const;
+  std::vector<int64_t> led_option(Index first, Index lead) const;
   void append_solution();
 
-  void cover(int64_t i);
-  void uncover(int64_t i);
-  void hide(int64_t p);
-  void unhide(int64_t p);
+  uint64_t search_in_parallel(int64_t thread_count, bool store_solutions);
+  uint64_t solve_jobs(WorkQueue &queue, bool store_solutions,
+                      std::vector<std::vector<Index>> &solution_paths);
+  void share_work(Index l);
+
+  // These run the engines other than the links; see backend.cpp.
+  Backend choose_engine();
+  SearchInput search_input();
+  void start_engine_search(Backend engine);
+  bool engine_search();
+  void leave_engine_search();
+
+  // These check the limits of a search; see search_limits.cpp.
+  void start_limits();
+  bool within_limits(Index l);
+  bool stop_search(SearchStatus reason);
+  double fraction_done(Index l);
+
+  // These are the steps of preprocess(); see preprocessing.cpp.
+  std::vector<Index> options_in_play();
+  bool is_blocked(Index x);
+  void remove_option(Index x);
+  int64_t remove_dominated_options(const std::vector<Index> &options);
+
+  void cover(Index i);
+  void uncover(Index i);
+  void hide(Index p);
+  void unhide(Index p);
+  void cover_other_items(Index x);
+  void uncover_other_items(Index x);
+  /* These take every option to have K items, or, for K = 0, any number;
+   * see hide_fixed().
+   */
+  template <int K> void hide_list(Index i);
+  template <int K> void unhide_list(Index i);
+  template <int K> void hide_fixed(Index p);
+  template <int K> void unhide_fixed(Index p);
+  template <int K> void cover_fixed(Index x);
+  template <int K> void uncover_fixed(Index x);
+  void hide_node(Node *node, Index q, Index x);
+  void unhide_node(Node *node, Index q, Index x);
+  void commit(Index p, Index j);
+  void uncommit(Index p, Index j);
+  void purify(Index p);
+  void unpurify(Index p);
+
+  // These are the steps of Algorithm M; see algorithm_m.cpp.
+  Index branching_degree(Index i);
+  Index choose_item_to_branch();
+  void tweak(Index x, Index p, bool hide_option);
+  void untweak(Index a, Index p, bool unhide_options);
+  void prepare_to_branch(Index i, Index l);
+  void tweak_option(Index x, Index i);
+  void try_option_with_bounds(Index x);
+  void untry_option_with_bounds(Index x);
+  void restore_item(Index i, Index l);
+  void reactivate_item(Index i);
+  void replay_level_with_bounds(Index x, Index l, bool is_tried);
+  void unwind_with_bounds();
 
   const std::string option_str(const std::vector<int64_t> &option) const;
 
@@ -69,14 +410,145 @@ private:
    */
   bool has_string_description;
   bool solved;
+  /* Items 1, ..., primary_count are primary; the rest are secondary.
+   * colors_description is either empty or parallel to options_description.
+   */
   std::vector<int64_t> items_description;
+  /* item_names holds the name of each item of a problem read by read_dlx(),
+   * whose items_description is then just 1, ..., N, and is otherwise empty.
+   */
+  std::vector<std::string> item_names;
+  Index primary_count;
   std::vector<std::vector<int64_t>> options_description;
+  std::vector<std::vector<int64_t>> colors_description;
   std::vector<Item> items;
   std::vector<Node> nodes;
-  std::vector<int64_t> candidate;
-  std::vector<std::vector<std::vector<int64_t>>> solutions;
+  /* node_colors holds the color of each node, and is empty when there are no
+   * colors. The nodes of items up to last_plain_item never have colors.
+   */
+  std::vector<Index> node_colors;
+  Index last_plain_item;
+  /* The number of items in every option, if they all have the same number
+   * and the search has a path for it, and otherwise 0. The first node of
+   * option k is then option_base + k * (option_width + 1).
+   */
+  int64_t option_width;
+  Index option_base;
+  std::vector<Index> candidate;
+  /* The nodes through which preprocess() chose the options it forced, which
+   * stay chosen beneath every search. Once preprocessed, or once a symmetry
+   * has been broken, the problem no longer takes multiplicities.
+   */
+  std::vector<Index> forced;
+  bool preprocessed;
+  /* The first node of each option, and the spacer after the last one, filled
+   * in the first time solve_with() needs them.
+   */
+  std::vector<Index> option_starts;
+  SolutionStore solutions;
+  // The option indices of the solution last reached by next_solution().
+  std::vector<int64_t> chosen_options;
+  bool has_length_buckets;
+  // Items up to last_bucketed_item are kept in length_buckets.
+  Index last_bucketed_item;
+  LengthBuckets length_buckets;
+  /* BOUND(i) and SLACK(i) of Algorithm M for each primary item i, and FT_l,
+   * the first node tweaked at each level l. These are empty unless there are
+   * multiplicities.
+   */
+  std::vector<Index> bound;
+  std::vector<Index> slack;
+  std::vector<Index> first_tweak;
+  /* The engine asked for, the one that ran the last search, and the one that
+   * holds the search under way. While that is not the links, they are left
+   * as they were, and engine_path takes the place of the candidate stack.
+   */
+  Backend backend;
+  Backend used_backend;
+  Backend search_engine;
+  BitsetEngine bitset_engine;
+  DancingCellsEngine dancing_cells;
+  std::vector<Index> engine_path;
+
+  /* The search position. Levels below root_level are fixed: the search ends
+   * rather than backtracking into them.
+   */
+  Index level;
+  Index root_level;
+  SearchState search_state;
+  uint64_t search_nodes;
+  SearchStatistics stats;
+  /* The limits of the search, and how it ended. The limits are checked only
+   * on entering the node counted by next_check, which is set well past the
+   * current count when nothing need be checked before then.
+   */
+  SearchLimits limits;
+  SearchStatus status;
+  uint64_t next_check;
+  uint64_t solutions_found;
+  std::chrono::steady_clock::time_point search_start;
+  std::chrono::steady_clock::time_point last_report;
+  uint64_t last_report_nodes;
+  std::chrono::steady_clock::time_point last_checkpoint;
+  /* resume_pending is set while a position loaded by resume() waits for the
+   * next search, which takes up its counts.
+   */
+  bool resume_pending;
+  uint64_t resume_nodes;
+  uint64_t resume_solutions;
+  // The nodes and solutions of a worker already added to the totals.
+  uint64_t shared_nodes;
+  uint64_t shared_solutions;
+  /* work_queue is set only while this problem is a worker in a parallel
+   * search.
+   */
+  WorkQueue *work_queue;
+};
+
+/* A SolutionRange is the input range returned by enumerate(). Advancing its
+ * iterator resumes the search until it reaches the next solution.
+ */
+template <typename Index>
+class BasicExactCoverProblem<Index>::SolutionRange {
+public:
+  class iterator {
+  public:
+    const SolutionView &operator*() const { return view; }
+    const SolutionView *operator->() const { return &view; }
+    iterator &operator++() {
+      if (!problem->next_solution()) {
+        problem = nullptr;
+      }
+      return *this;
+    }
+    bool operator==(const iterator &other) const {
+      return problem == other.problem;
+    }
+    bool operator!=(const iterator &other) const {
+      return problem != other.problem;
+    }
+
+  private:
+    friend class SolutionRange;
+    explicit iterator(BasicExactCoverProblem *problem)
+        : problem(problem), view(problem->chosen_options) {}
+    iterator() : problem(nullptr) {}
+
+    BasicExactCoverProblem *problem; // null once the search is exhausted
+    SolutionView view;
+  };
+
+  explicit SolutionRange(BasicExactCoverProblem *problem) : problem(problem) {}
+  iterator begin() { return ++iterator(problem); }
+  iterator end() { return iterator(); }
+
+private:
+  BasicExactCoverProblem *problem;
 };
 
+using ExactCoverProblem = BasicExactCoverProblem<int64_t>;
+using CompactExactCoverProblem = BasicExactCoverProblem<int32_t>;
+
 } // namespace algorithm_x
 
 #endif // #define ALGORITHM_X_H
@@ -0,0 +1,161 @@
+#include "algorithm_x.h"
+#include "zdd.h"
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace algorithm_x {
+
+namespace {
+
+// A signature has one bit for each item, set if the item is still active.
+struct SignatureHash {
+  std::size_t operator()(const std::vector<uint64_t> &signature) const {
+    uint64_t h = 0;
+    for (uint64_t word : signature) {
+      h = (h ^ word) * 0x9e3779b97f4a7c15;
+    }
+    return h ^ (h >> 29);
+  }
+};
+
+} // namespace
+
+template <typename Index>
+Zdd BasicExactCoverProblem<Index>::build_zdd(int64_t cache_bytes) {
+  /*
+   * This is an implementation of Donald Knuth's Algorithm Z, exact covering
+   * with memos, from _The Art of Computer Programming_, volume 4, fascicle 5.
+   * It follows Algorithm X, but the subproblem left at each node of the search
+   * tree is determined by the items still active, since an option is hidden
+   * just when one of its items has been covered. The first time a subproblem is
+   * met, its solutions are built into the Zdd and remembered under its
+   * signature; every later time, they are simply looked up.
+   *
+   * The solutions of a subproblem in which item i is chosen are the options of
+   * i, each with the solutions of the subproblem it leaves. They are chained
+   * together from the last option up, so that the first option heads the chain.
+   */
+  if (!node_colors.empty() || !bound.empty()) {
+    throw std::logic_error("Algorithm Z handles neither colors nor "
+                           "multiplicities.");
+  }
+  if (cache_bytes < 0) {
+    throw std::invalid_argument("The cache cannot have a negative size.");
+  }
+  // Abandon any search under way.
+  start_search();
+  search_state = SearchState::finished;
+  search_nodes = 0;
+  ALGORITHM_X_COUNT(stats.clear());
+  ALGORITHM_X_TIME(stats.search_seconds);
+
+  Zdd zdd;
+  Index n = items_description.size();
+  int64_t words = (n + 64) / 64;
+  std::unordered_map<std::vector<uint64_t>, int64_t, SignatureHash> memo;
+  /* The size of a memo is roughly that of its signature, the vector holding
+   * it, its result, and the node and bucket of the hash table.
+   */
+  int64_t memo_bytes = words * sizeof(uint64_t) +
+                       sizeof(std::vector<uint64_t>) + sizeof(int64_t) +
+                       3 * sizeof(void *);
+  int64_t cache_used = 0;
+  // The signature of the subproblem at each level, and the chain built so far.
+  std::vector<std::vector<uint64_t>> signatures;
+  std::vector<int64_t> below;
+  int64_t result;
+  Index l = 0;
+  Index i;
+  Index x;
+
+  /* Z2
+   * Enter level l.
+   */
+z2:
+  ++search_nodes;
+  ALGORITHM_X_COUNT(stats.count_node(l));
+  if (items[0].rlink == 0) {
+    result = Zdd::top;
+    goto z7;
+  }
+  if ((Index)signatures.size() <= l) {
+    signatures.resize(l + 1);
+  }
+  signatures[l].assign(words, 0);
+  for (i = items[0].rlink; i != 0; i = items[i].rlink) {
+    signatures[l][i / 64] |= uint64_t(1) << (i % 64);
+  }
+  for (i = items[n + 1].rlink; i != n + 1; i = items[i].rlink) {
+    signatures[l][i / 64] |= uint64_t(1) << (i % 64);
+  }
+  {
+    auto found = memo.find(signatures[l]);
+    if (found != memo.end()) {
+      result = found->second;
+      goto z7;
+    }
+  }
+
+  /* Z3
+   * Choose i, and cover it.
+   */
+  // z3:
+  i = choose_item_to_cover();
+  cover(i);
+  candidate.push_back(nodes[i].ulink);
+  below.push_back(Zdd::bottom);
+
+  /* Z5
+   * Try x_l.
+   */
+z5:
+  x = candidate[l];
+  if (x == i) {
+    // The chain for i is complete. Remember it.
+    uncover(i);
+    candidate.pop_back();
+    result = below.back();
+    below.pop_back();
+    if (cache_used + memo_bytes > cache_bytes) {
+      // The cache is full. Start it afresh.
+      memo.clear();
+      cache_used = 0;
+    }
+    if (memo_bytes <= cache_bytes) {
+      memo.emplace(signatures[l], result);
+      cache_used += memo_bytes;
+    }
+    goto z7;
+  }
+  cover_other_items(x);
+  ++l;
+  goto z2;
+
+  /* Z7
+   * Leave level l with the Zdd of its subproblem, and add it to the chain of
+   * the level above.
+   */
+z7:
+  if (l == 0) {
+    // The options forced by preprocess() belong to every solution.
+    for (auto x = forced.rbegin(); x != forced.rend(); ++x) {
+      result = zdd.make_node(option_of(*x), Zdd::bottom, result);
+    }
+    zdd.root_node = result;
+    return zdd;
+  }
+  --l;
+  x = candidate[l];
+  uncover_other_items(x);
+  below[l] = zdd.make_node(option_of(x), below[l], result);
+  i = nodes[x].top;
+  candidate[l] = nodes[x].ulink;
+  goto z5;
+}
+
+template Zdd BasicExactCoverProblem<int32_t>::build_zdd(int64_t);
+template Zdd BasicExactCoverProblem<int64_t>::build_zdd(int64_t);
+
+} // namespace algorithm_x
@@ -0,0 +1,169 @@
+#include "algorithm_x.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace algorithm_x {
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::use_backend(Backend chosen) {
+  backend = chosen;
+}
+
+/* choose_engine() chooses the engine for a search on one thread about to
+ * start from the root. It must follow start_limits(), which leaves
+ * next_check at its largest only if there are no limits to check. The
+ * automatic choice never changes the order of the solutions, so it is
+ * between the links and the bitset engine alone.
+ */
+template <typename Index>
+Backend BasicExactCoverProblem<Index>::choose_engine() {
+  bool is_plain = bound.empty() && node_colors.empty() &&
+                  work_queue == nullptr &&
+                  next_check == std::numeric_limits<uint64_t>::max();
+  if (!is_plain) {
+    return Backend::dancing_links;
+  }
+  switch (backend) {
+  case Backend::automatic: {
+    bool is_small =
+        primary_count * ((option_count() + 63) / 64) <= bitset_size_limit;
+    return is_small && !SearchStatistics::enabled ? Backend::bitset
+                                                  : Backend::dancing_links;
+  }
+  case Backend::dancing_cells: {
+    // The cells and the sets are indexed by 32 bits.
+    bool fits = (int64_t)(nodes.size() + 2 * items.size()) <
+                std::numeric_limits<int32_t>::max();
+    return fits ? Backend::dancing_cells : Backend::dancing_links;
+  }
+  default:
+    return backend;
+  }
+}
+
+/* search_input() gives what is left of the problem as the links stand, for
+ * an engine to search. Each option is found through the node that follows
+ * its spacer.
+ */
+template <typename Index>
+SearchInput BasicExactCoverProblem<Index>::search_input() {
+  SearchInput input;
+  std::vector<int64_t> local(items.size(), -1);
+  std::vector<std::pair<int64_t, Index>> options;
+  for (Index i = items[0].rlink; i != 0; i = items[i].rlink) {
+    local[i] = input.primary_count++;
+    for (Index x = nodes[i].dlink; x != i; x = nodes[x].dlink) {
+      Index first = x;
+      while (nodes[first - 1].top > 0) {
+        --first;
+      }
+      options.emplace_back(-nodes[first - 1].top, first);
+    }
+  }
+  std::sort(options.begin(), options.end());
+  options.erase(std::unique(options.begin(), options.end()), options.end());
+  input.item_count = input.primary_count;
+  for (const std::pair<int64_t, Index> &option : options) {
+    for (Index x = option.second; nodes[x].top > 0; ++x) {
+      if (local[nodes[x].top] < 0) {
+        local[nodes[x].top] = input.item_count++;
+      }
+      input.items.push_back(local[nodes[x].top]);
+      input.nodes.push_back(x);
+    }
+    input.option_start.push_back(input.items.size());
+  }
+  return input;
+}
+
+// start_engine_search() starts a search by the given engine.
+template <typename Index>
+void BasicExactCoverProblem<Index>::start_engine_search(Backend engine) {
+  SearchInput input = search_input();
+  if (engine == Backend::bitset) {
+    bitset_engine.load(input);
+    bitset_engine.start();
+  } else {
+    dancing_cells.load(input);
+    dancing_cells.start();
+  }
+  engine_path.reserve(input.primary_count);
+  search_engine = engine;
+  used_backend = engine;
+  // The dancing links take no part.
+  search_state = SearchState::finished;
+}
+
+/* engine_search() is algorithm_x() for the other engines: it returns true
+ * whenever it reaches a solution, which it leaves in engine_path, and false
+ * once the tree has been exhausted.
+ */
+template <typename Index> bool BasicExactCoverProblem<Index>::engine_search() {
+  bool is_bitset = search_engine == Backend::bitset;
+  uint64_t nodes_before =
+      is_bitset ? bitset_engine.node_count() : dancing_cells.node_count();
+  bool is_found = is_bitset ? bitset_engine.next() : dancing_cells.next();
+  search_nodes +=
+      (is_bitset ? bitset_engine.node_count() : dancing_cells.node_count()) -
+      nodes_before;
+  if (!is_found) {
+    search_engine = Backend::dancing_links;
+    bitset_engine.clear();
+    dancing_cells.clear();
+    return false;
+  }
+  ALGORITHM_X_COUNT(++stats.solutions);
+  ++solutions_found;
+  const std::vector<int64_t> &path =
+      is_bitset ? bitset_engine.path() : dancing_cells.path();
+  engine_path.assign(path.begin(), path.end());
+  return true;
+}
+
+/* leave_engine_search() hands a search paused by another engine over to the
+ * dancing links, by choosing the options of its path through their nodes,
+ * so that checkpoint() can save it and the search can go on as if it had
+ * been run by algorithm_x() all along. Only the bitset engine searches in
+ * the order of the links, so a search by dancing cells can be handed over
+ * only before it has begun.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::leave_engine_search() {
+  if (search_engine == Backend::dancing_links) {
+    return;
+  }
+  bool is_at_solution = search_engine == Backend::bitset
+                            ? bitset_engine.is_at_solution()
+                            : dancing_cells.is_at_solution();
+  if (is_at_solution && search_engine == Backend::dancing_cells) {
+    throw std::logic_error("A search by dancing cells cannot be "
+                           "checkpointed.");
+  }
+  start_search();
+  if (is_at_solution) {
+    for (Index l = 0; l < (Index)engine_path.size(); ++l) {
+      replay_level(engine_path[l], l, true);
+    }
+    level = engine_path.size();
+    search_state = SearchState::leave_level;
+  }
+}
+
+template void BasicExactCoverProblem<int32_t>::use_backend(Backend);
+template void BasicExactCoverProblem<int64_t>::use_backend(Backend);
+template Backend BasicExactCoverProblem<int32_t>::choose_engine();
+template Backend BasicExactCoverProblem<int64_t>::choose_engine();
+template SearchInput BasicExactCoverProblem<int32_t>::search_input();
+template SearchInput BasicExactCoverProblem<int64_t>::search_input();
+template void BasicExactCoverProblem<int32_t>::start_engine_search(Backend);
+template void BasicExactCoverProblem<int64_t>::start_engine_search(Backend);
+template bool BasicExactCoverProblem<int32_t>::engine_search();
+template bool BasicExactCoverProblem<int64_t>::engine_search();
+template void BasicExactCoverProblem<int32_t>::leave_engine_search();
+template void BasicExactCoverProblem<int64_t>::leave_engine_search();
+
+} // namespace algorithm_x
@@ -0,0 +1,48 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include <cstdint>
+#include <vector>
+
+namespace algorithm_x {
+
+/* Backend names the engine that runs a search; see use_backend(). The
+ * automatic choice is made by the size of the problem.
+ */
+enum class Backend { automatic, dancing_links, bitset, dancing_cells };
+
+inline const char *backend_name(Backend backend) {
+  switch (backend) {
+  case Backend::automatic:
+    return "automatic";
+  case Backend::dancing_links:
+    return "dancing-links";
+  case Backend::bitset:
+    return "bitset";
+  case Backend::dancing_cells:
+    return "dancing-cells";
+  }
+  return "unknown";
+}
+
+/* A SearchInput is what is left of a problem for an engine other than the
+ * dancing links to search: its active primary items, numbered from 0 in the
+ * order of their list, then the secondary items that share options with
+ * them, numbered from primary_count on, and the options in their lists, in
+ * order of index. The items of option k are items[option_start[k]], ...,
+ * items[option_start[k + 1] - 1], in the order in which they were given, and
+ * nodes holds the node that stands for each in the node table of the problem.
+ */
+struct SearchInput {
+  int64_t primary_count = 0;
+  int64_t item_count = 0;
+  std::vector<int64_t> option_start{0};
+  std::vector<int64_t> items;
+  std::vector<int64_t> nodes;
+
+  int64_t option_count() const { return option_start.size() - 1; }
+};
+
+} // namespace algorithm_x
+
+#endif // #define BACKEND_H
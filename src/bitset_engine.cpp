@@ -0,0 +1,359 @@
+#include "bitset_engine.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define ALGORITHM_X_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace algorithm_x {
+
+namespace {
+
+uint64_t and_count_portable(const uint64_t *a, const uint64_t *b,
+                            int64_t words) {
+  uint64_t count = 0;
+  for (int64_t k = 0; k < words; ++k) {
+    count += __builtin_popcountll(a[k] & b[k]);
+  }
+  return count;
+}
+
+void and_not_portable(uint64_t *target, const uint64_t *source,
+                      const uint64_t *mask, int64_t words) {
+  for (int64_t k = 0; k < words; ++k) {
+    target[k] = source[k] & ~mask[k];
+  }
+}
+
+const BitsetKernels portable_kernels = {"portable", and_count_portable,
+                                        and_not_portable};
+
+#ifdef ALGORITHM_X_X86_KERNELS
+
+// The same loop, but with __builtin_popcountll as a single instruction.
+__attribute__((target("popcnt"))) uint64_t
+and_count_popcnt(const uint64_t *a, const uint64_t *b, int64_t words) {
+  uint64_t count = 0;
+  for (int64_t k = 0; k < words; ++k) {
+    count += __builtin_popcountll(a[k] & b[k]);
+  }
+  return count;
+}
+
+/* Without an instruction to count the bits of a vector, AVX2 and AVX-512BW
+ * look up the counts of the two nibbles of each byte in a table held in a
+ * register, add them, and sum the bytes of each 64-bit lane with SAD against
+ * zero, as in Mula, Kurz and Lemire, "Faster population counts using AVX2
+ * instructions" (2018).
+ */
+__attribute__((target("avx2,popcnt"))) uint64_t
+and_count_avx2(const uint64_t *a, const uint64_t *b, int64_t words) {
+  const __m256i table =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                       2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+  __m256i totals = _mm256_setzero_si256();
+  int64_t k = 0;
+  for (; k + 4 <= words; k += 4) {
+    __m256i v = _mm256_and_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + k)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + k)));
+    __m256i low = _mm256_and_si256(v, low_nibbles);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, low),
+                                     _mm256_shuffle_epi8(table, high));
+    totals = _mm256_add_epi64(totals,
+                              _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+  }
+  uint64_t count = _mm256_extract_epi64(totals, 0) +
+                   _mm256_extract_epi64(totals, 1) +
+                   _mm256_extract_epi64(totals, 2) +
+                   _mm256_extract_epi64(totals, 3);
+  for (; k < words; ++k) {
+    count += __builtin_popcountll(a[k] & b[k]);
+  }
+  return count;
+}
+
+__attribute__((target("avx2"))) void and_not_avx2(uint64_t *target,
+                                                  const uint64_t *source,
+                                                  const uint64_t *mask,
+                                                  int64_t words) {
+  int64_t k = 0;
+  for (; k + 4 <= words; k += 4) {
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(target + k),
+        _mm256_andnot_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + k)),
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(source + k))));
+  }
+  for (; k < words; ++k) {
+    target[k] = source[k] & ~mask[k];
+  }
+}
+
+/* GCC 12 warns of the deliberately undefined vectors inside several of the
+ * AVX-512 intrinsics.
+ */
+#ifndef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/* With AVX-512 the words left over after the last whole vector are loaded
+ * and stored under a mask, so that there is no scalar tail.
+ */
+__attribute__((target("avx512f,avx512bw"))) uint64_t
+and_count_avx512bw(const uint64_t *a, const uint64_t *b, int64_t words) {
+  const __m512i table = _mm512_broadcast_i32x4(
+      _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+  const __m512i low_nibbles = _mm512_set1_epi8(0x0f);
+  __m512i totals = _mm512_setzero_si512();
+  for (int64_t k = 0; k < words; k += 8) {
+    __mmask8 lanes = words - k >= 8 ? 0xff : (1u << (words - k)) - 1;
+    __m512i v = _mm512_and_si512(_mm512_maskz_loadu_epi64(lanes, a + k),
+                                 _mm512_maskz_loadu_epi64(lanes, b + k));
+    __m512i low = _mm512_and_si512(v, low_nibbles);
+    __m512i high = _mm512_and_si512(_mm512_srli_epi16(v, 4), low_nibbles);
+    __m512i counts = _mm512_add_epi8(_mm512_shuffle_epi8(table, low),
+                                     _mm512_shuffle_epi8(table, high));
+    totals = _mm512_add_epi64(totals,
+                              _mm512_sad_epu8(counts, _mm512_setzero_si512()));
+  }
+  return _mm512_reduce_add_epi64(totals);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) uint64_t
+and_count_avx512(const uint64_t *a, const uint64_t *b, int64_t words) {
+  __m512i totals = _mm512_setzero_si512();
+  for (int64_t k = 0; k < words; k += 8) {
+    __mmask8 lanes = words - k >= 8 ? 0xff : (1u << (words - k)) - 1;
+    __m512i v = _mm512_and_si512(_mm512_maskz_loadu_epi64(lanes, a + k),
+                                 _mm512_maskz_loadu_epi64(lanes, b + k));
+    totals = _mm512_add_epi64(totals, _mm512_popcnt_epi64(v));
+  }
+  return _mm512_reduce_add_epi64(totals);
+}
+
+__attribute__((target("avx512f"))) void and_not_avx512(uint64_t *target,
+                                                       const uint64_t *source,
+                                                       const uint64_t *mask,
+                                                       int64_t words) {
+  for (int64_t k = 0; k < words; k += 8) {
+    __mmask8 lanes = words - k >= 8 ? 0xff : (1u << (words - k)) - 1;
+    _mm512_mask_storeu_epi64(
+        target + k, lanes,
+        _mm512_andnot_si512(_mm512_maskz_loadu_epi64(lanes, mask + k),
+                            _mm512_maskz_loadu_epi64(lanes, source + k)));
+  }
+}
+
+#ifndef __clang__
+#pragma GCC diagnostic pop
+#endif
+
+const BitsetKernels popcnt_kernels = {"popcnt", and_count_popcnt,
+                                      and_not_portable};
+const BitsetKernels avx2_kernels = {"avx2", and_count_avx2, and_not_avx2};
+const BitsetKernels avx512bw_kernels = {"avx512bw", and_count_avx512bw,
+                                        and_not_avx512};
+const BitsetKernels avx512_kernels = {"avx512vpopcntdq", and_count_avx512,
+                                      and_not_avx512};
+
+#endif // #ifdef ALGORITHM_X_X86_KERNELS
+
+} // namespace
+
+std::vector<const BitsetKernels *> supported_bitset_kernels() {
+  std::vector<const BitsetKernels *> supported;
+#ifdef ALGORITHM_X_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+      supported.push_back(&avx512_kernels);
+    }
+    if (__builtin_cpu_supports("avx512bw")) {
+      supported.push_back(&avx512bw_kernels);
+    }
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+    supported.push_back(&avx2_kernels);
+  }
+  if (__builtin_cpu_supports("popcnt")) {
+    supported.push_back(&popcnt_kernels);
+  }
+#endif
+  supported.push_back(&portable_kernels);
+  return supported;
+}
+
+const BitsetKernels &bitset_kernels() {
+  static const BitsetKernels *chosen = supported_bitset_kernels().front();
+  return *chosen;
+}
+
+void BitsetEngine::load(const SearchInput &input) {
+  primary_count = input.primary_count;
+  item_count = input.item_count;
+  option_count = input.option_count();
+  option_words = (option_count + 63) / 64;
+  item_words = (primary_count + 63) / 64;
+  option_start = input.option_start;
+  option_items = input.items;
+  option_nodes = input.nodes;
+  columns.assign(item_count * option_words, 0);
+  rows.assign(option_count * item_words, 0);
+  for (int64_t k = 0; k < option_count; ++k) {
+    for (int64_t m = option_start[k]; m < option_start[k + 1]; ++m) {
+      int64_t j = option_items[m];
+      columns[j * option_words + k / 64] |= uint64_t(1) << (k % 64);
+      if (j < primary_count) {
+        rows[k * item_words + j / 64] |= uint64_t(1) << (j % 64);
+      }
+    }
+  }
+  state = State::finished;
+  nodes_entered = 0;
+}
+
+void BitsetEngine::start() {
+  kernels = &bitset_kernels();
+  // Every level covers a primary item, so there are at most this many.
+  int64_t depth = primary_count + 1;
+  active_options.assign(depth * option_words, 0);
+  active_items.assign(depth * item_words, 0);
+  for (int64_t k = 0; k < option_count; ++k) {
+    active_options[k / 64] |= uint64_t(1) << (k % 64);
+  }
+  for (int64_t j = 0; j < primary_count; ++j) {
+    active_items[j / 64] |= uint64_t(1) << (j % 64);
+  }
+  chosen_item.assign(depth, -1);
+  chosen_option.assign(depth, -1);
+  chosen_nodes.clear();
+  chosen_nodes.reserve(depth);
+  level = 0;
+  nodes_entered = 0;
+  state = State::entering;
+}
+
+/* next() follows algorithm_x() step by step, so that the two search the same
+ * tree: level l holds the options and items left by the options chosen at
+ * levels 0, ..., l - 1.
+ */
+bool BitsetEngine::next() {
+  int64_t l = level;
+
+  switch (state) {
+  case State::entering:
+    goto enter_level;
+  case State::at_solution:
+    goto leave_level;
+  case State::finished:
+    return false;
+  }
+
+enter_level: {
+  ++nodes_entered;
+  const uint64_t *options = active_options.data() + l * option_words;
+  const uint64_t *items = active_items.data() + l * item_words;
+  /* Choose the item with the fewest active options, the first of them in
+   * the order of the list of items if several tie, as by MRV.
+   */
+  int64_t i = -1;
+  uint64_t shortest = std::numeric_limits<uint64_t>::max();
+  for (int64_t w = 0; w < item_words && shortest > 0; ++w) {
+    for (uint64_t bits = items[w]; bits != 0; bits &= bits - 1) {
+      int64_t j = w * 64 + __builtin_ctzll(bits);
+      uint64_t length = kernels->and_count(
+          columns.data() + j * option_words, options, option_words);
+      if (length < shortest) {
+        shortest = length;
+        i = j;
+        if (length == 0) {
+          break;
+        }
+      }
+    }
+  }
+  if (i < 0) {
+    // Every primary item has been covered.
+    level = l;
+    state = State::at_solution;
+    return true;
+  }
+  chosen_item[l] = i;
+  chosen_option[l] = -1;
+}
+
+try_option: {
+  int64_t k = next_option(l);
+  if (k < 0) {
+    goto leave_level;
+  }
+  chosen_option[l] = k;
+  // Drop every option that shares an item with option k.
+  const uint64_t *options = active_options.data() + l * option_words;
+  uint64_t *next_options = active_options.data() + (l + 1) * option_words;
+  int64_t first = option_start[k];
+  kernels->and_not(next_options, options,
+                   columns.data() + option_items[first] * option_words,
+                   option_words);
+  for (int64_t m = first + 1; m < option_start[k + 1]; ++m) {
+    kernels->and_not(next_options, next_options,
+                     columns.data() + option_items[m] * option_words,
+                     option_words);
+  }
+  kernels->and_not(active_items.data() + (l + 1) * item_words,
+                   active_items.data() + l * item_words,
+                   rows.data() + k * item_words, item_words);
+  int64_t m = first;
+  while (option_items[m] != chosen_item[l]) {
+    ++m;
+  }
+  chosen_nodes.resize(l + 1);
+  chosen_nodes[l] = option_nodes[m];
+  ++l;
+  goto enter_level;
+}
+
+leave_level:
+  if (l == 0) {
+    level = l;
+    state = State::finished;
+    return false;
+  }
+  --l;
+  goto try_option;
+}
+
+/* next_option() returns the first option after the one last tried at level
+ * l that contains the item chosen there and is still active, or -1 if there
+ * is none.
+ */
+int64_t BitsetEngine::next_option(int64_t l) {
+  const uint64_t *column = columns.data() + chosen_item[l] * option_words;
+  const uint64_t *options = active_options.data() + l * option_words;
+  int64_t k = chosen_option[l] + 1;
+  int64_t w = k / 64;
+  if (w >= option_words) {
+    return -1;
+  }
+  uint64_t bits = column[w] & options[w] & (~uint64_t(0) << (k % 64));
+  while (bits == 0) {
+    if (++w == option_words) {
+      return -1;
+    }
+    bits = column[w] & options[w];
+  }
+  return w * 64 + __builtin_ctzll(bits);
+}
+
+void BitsetEngine::clear() { *this = BitsetEngine(); }
+
+} // namespace algorithm_x
@@ -0,0 +1,97 @@
+#ifndef BITSET_ENGINE_H
+#define BITSET_ENGINE_H
+
+#include "backend.h"
+#include <cstdint>
+#include <vector>
+
+namespace algorithm_x {
+
+/* BitsetKernels are the word-parallel loops of the bitset engine, chosen once
+ * for the processor at hand: AVX-512 with its population count, AVX-512 or
+ * AVX2 with a table of the counts of nibbles, the POPCNT instruction alone,
+ * or plain C++ where none of these is to be had. and_count() counts the bits
+ * set in both a and b, and and_not() sets target to source & ~mask, over the
+ * given number of 64-bit words.
+ */
+struct BitsetKernels {
+  const char *name;
+  uint64_t (*and_count)(const uint64_t *a, const uint64_t *b, int64_t words);
+  void (*and_not)(uint64_t *target, const uint64_t *source,
+                  const uint64_t *mask, int64_t words);
+};
+
+const BitsetKernels &bitset_kernels();
+/* supported_bitset_kernels() lists every variant the processor can run, the
+ * one chosen by bitset_kernels() first and plain C++ last.
+ */
+std::vector<const BitsetKernels *> supported_bitset_kernels();
+
+/**
+ * BitsetEngine runs Algorithm X on bitsets rather than on dancing links, which
+ * pays for small dense problems, whose lists are short and whose bitsets fit
+ * in a few cache lines. Each item has a column, the bitset of the options
+ * that contain it, and each option a row, the bitset of its primary items. At
+ * each level of the search, the options still active are a bitset, in which
+ * choosing an option clears the columns of all of its items, and the primary
+ * items still to be covered are another, from which it clears its row.
+ *
+ * The length of the list of an item is then the number of bits in its column
+ * and the active options, and the item chosen is the first of the shortest,
+ * with its options tried in order, just as by the dancing links. So the
+ * search visits the same tree, and reaches the same solutions in the same
+ * order.
+ */
+class BitsetEngine {
+public:
+  // load() sets up the engine to search the given problem.
+  void load(const SearchInput &input);
+  // start() begins a search of the problem loaded.
+  void start();
+  /* next() resumes the search until it reaches the next solution, returning
+   * false if there are no more.
+   */
+  bool next();
+  /* path() lists, for each level of the solution last reached, the node of
+   * the option chosen there in the list of the item chosen there.
+   */
+  const std::vector<int64_t> &path() const { return chosen_nodes; }
+  uint64_t node_count() const { return nodes_entered; }
+  bool is_at_solution() const { return state == State::at_solution; }
+  // clear() releases the memory of the engine.
+  void clear();
+
+private:
+  enum class State { entering, at_solution, finished };
+
+  int64_t next_option(int64_t l);
+
+  const BitsetKernels *kernels = nullptr;
+  int64_t primary_count = 0;
+  int64_t item_count = 0;
+  int64_t option_count = 0;
+  // The numbers of words in a bitset of options and of primary items.
+  int64_t option_words = 0;
+  int64_t item_words = 0;
+  // The items of option k, and their nodes, from option_start[k] on.
+  std::vector<int64_t> option_start;
+  std::vector<int64_t> option_items;
+  std::vector<int64_t> option_nodes;
+  std::vector<uint64_t> columns;
+  std::vector<uint64_t> rows;
+  /* The active options and the primary items still to be covered on entering
+   * each level, and the item and the option chosen there.
+   */
+  std::vector<uint64_t> active_options;
+  std::vector<uint64_t> active_items;
+  std::vector<int64_t> chosen_item;
+  std::vector<int64_t> chosen_option;
+  std::vector<int64_t> chosen_nodes;
+  int64_t level = 0;
+  State state = State::finished;
+  uint64_t nodes_entered = 0;
+};
+
+} // namespace algorithm_x
+
+#endif // #define BITSET_ENGINE_H
@@ -0,0 +1,226 @@
+#include "dancing_cells.h"
+#include <cstdint>
+#include <vector>
+
+namespace algorithm_x {
+
+void DancingCellsEngine::load(const SearchInput &input) {
+  /* Lay out the sets in the order of the items, primary ones first, each
+   * with room for all of its options.
+   */
+  std::vector<int32_t> length(input.item_count, 0);
+  for (int64_t j : input.items) {
+    ++length[j];
+  }
+  std::vector<int32_t> start(input.item_count);
+  set.clear();
+  for (int64_t j = 0; j < input.item_count; ++j) {
+    if (j == input.primary_count) {
+      second = set.size() + 2;
+    }
+    set.resize(set.size() + 2);
+    start[j] = set.size();
+    set.resize(set.size() + length[j]);
+  }
+  if (input.item_count == input.primary_count) {
+    second = set.size() + 2;
+  }
+
+  cells.assign(1, Cell{-1, 0});
+  cell_nodes.assign(1, 0);
+  for (int64_t k = 0; k < input.option_count(); ++k) {
+    int32_t first = cells.size();
+    for (int64_t m = input.option_start[k]; m < input.option_start[k + 1];
+         ++m) {
+      int32_t i = start[input.items[m]];
+      cells.push_back(Cell{i, size(i)});
+      set[i + size(i)++] = cells.size() - 1;
+      cell_nodes.push_back(input.nodes[m]);
+    }
+    cells.push_back(Cell{-1, first});
+    cell_nodes.push_back(0);
+  }
+  active.assign(start.begin(), start.begin() + input.primary_count);
+  for (int32_t k = 0; k < (int32_t)active.size(); ++k) {
+    pos(active[k]) = k;
+  }
+  state = State::finished;
+  nodes_entered = 0;
+}
+
+void DancingCellsEngine::start() {
+  active_count = active.size();
+  // Every level covers a primary item, so there are at most this many.
+  chosen_item.assign(active.size() + 1, 0);
+  tried.assign(active.size() + 1, 0);
+  chosen_nodes.clear();
+  chosen_nodes.reserve(active.size() + 1);
+  level = 0;
+  nodes_entered = 0;
+  state = State::entering;
+}
+
+/* deactivate() swaps primary item i to the end of the active items. Items
+ * come back, as options do, by growing active_count.
+ */
+void DancingCellsEngine::deactivate(int32_t i) {
+  int32_t last = active[--active_count];
+  int32_t k = pos(i);
+  active[k] = last;
+  pos(last) = k;
+  active[active_count] = i;
+  pos(i) = active_count;
+}
+
+// hide() removes the option of cell p from the sets of its other items.
+void DancingCellsEngine::hide(int32_t p) {
+  int32_t q = p + 1;
+  while (q != p) {
+    int32_t j = cells[q].item;
+    if (j < 0) {
+      q = cells[q].loc;
+      continue;
+    }
+    int32_t s = --size(j);
+    int32_t last = set[j + s];
+    int32_t k = cells[q].loc;
+    set[j + k] = last;
+    cells[last].loc = k;
+    set[j + s] = q;
+    cells[q].loc = s;
+    ++q;
+  }
+}
+
+void DancingCellsEngine::unhide(int32_t p) {
+  int32_t q = p + 1;
+  while (q != p) {
+    int32_t j = cells[q].item;
+    if (j < 0) {
+      q = cells[q].loc;
+      continue;
+    }
+    ++size(j);
+    ++q;
+  }
+}
+
+/* cover() hides every active option of item i, which leaves the set of i
+ * itself alone, so that its options can be tried from it.
+ */
+void DancingCellsEngine::cover(int32_t i) {
+  if (i < second) {
+    deactivate(i);
+  }
+  for (int32_t k = 0; k < size(i); ++k) {
+    hide(set[i + k]);
+  }
+}
+
+void DancingCellsEngine::uncover(int32_t i) {
+  for (int32_t k = 0; k < size(i); ++k) {
+    unhide(set[i + k]);
+  }
+  if (i < second) {
+    ++active_count;
+  }
+}
+
+void DancingCellsEngine::cover_other_items(int32_t p) {
+  int32_t q = p + 1;
+  while (q != p) {
+    int32_t j = cells[q].item;
+    if (j < 0) {
+      q = cells[q].loc;
+      continue;
+    }
+    cover(j);
+    ++q;
+  }
+}
+
+/* uncover_other_items() undoes cover_other_items() in the opposite order,
+ * which matters: uncovering an item grows the sets of the items covered after
+ * it, and each of those must be uncovered while its size is as it was left.
+ */
+void DancingCellsEngine::uncover_other_items(int32_t p) {
+  int32_t end = p + 1;
+  while (cells[end].item >= 0) {
+    ++end;
+  }
+  for (int32_t q = p - 1; q >= cells[end].loc; --q) {
+    uncover(cells[q].item);
+  }
+  for (int32_t q = end - 1; q > p; --q) {
+    uncover(cells[q].item);
+  }
+}
+
+/* next() follows algorithm_x(), except that nothing hidden is put back in
+ * its old place: each size only grows back by as much as it shrank, and the
+ * sets are left with the same entries, if not in the same places.
+ */
+bool DancingCellsEngine::next() {
+  int64_t l = level;
+  int32_t i;
+
+  switch (state) {
+  case State::entering:
+    goto enter_level;
+  case State::at_solution:
+    goto leave_level;
+  case State::finished:
+    return false;
+  }
+
+enter_level: {
+  ++nodes_entered;
+  if (active_count == 0) {
+    level = l;
+    state = State::at_solution;
+    return true;
+  }
+  // The sets begin in the order of the items, which breaks ties.
+  i = active[0];
+  int32_t shortest = size(i);
+  for (int32_t k = 1; k < active_count && shortest > 0; ++k) {
+    int32_t j = active[k];
+    if (size(j) < shortest || (size(j) == shortest && j < i)) {
+      i = j;
+      shortest = size(j);
+    }
+  }
+  cover(i);
+  chosen_item[l] = i;
+  tried[l] = 0;
+}
+
+try_option: {
+  i = chosen_item[l];
+  if (tried[l] == size(i)) {
+    uncover(i);
+    goto leave_level;
+  }
+  int32_t p = set[i + tried[l]];
+  cover_other_items(p);
+  chosen_nodes.resize(l + 1);
+  chosen_nodes[l] = cell_nodes[p];
+  ++l;
+  goto enter_level;
+}
+
+leave_level:
+  if (l == 0) {
+    level = l;
+    state = State::finished;
+    return false;
+  }
+  --l;
+  uncover_other_items(set[chosen_item[l] + tried[l]]);
+  ++tried[l];
+  goto try_option;
+}
+
+void DancingCellsEngine::clear() { *this = DancingCellsEngine(); }
+
+} // namespace algorithm_x
@@ -0,0 +1,92 @@
+#ifndef DANCING_CELLS_H
+#define DANCING_CELLS_H
+
+#include "backend.h"
+#include <cstdint>
+#include <vector>
+
+namespace algorithm_x {
+
+/**
+ * DancingCellsEngine runs Algorithm X on sparse sets rather than on dancing
+ * links, after Knuth's program SSXC1 and the representation he calls dancing
+ * cells. Each item keeps the options that contain it in a set: an array whose
+ * first SIZE(i) entries are the active ones, with the others after them. An
+ * option is hidden from an item by swapping it with the last active entry and
+ * shrinking the size, and the active primary items form such a set too. Nothing
+ * is ever relinked: as the search backtracks, growing each size back brings
+ * back the entries that were swapped out, in whatever order they now stand. The
+ * sets are packed in one array, each just after its POS and SIZE, so that
+ * choosing an item and hiding options walk along consecutive words rather than
+ * chasing links across the node table, and the cells take 32 bits each.
+ *
+ * The item chosen is one of the shortest, the first of them in the order of
+ * the items if several tie, as by the dancing links, and its options are
+ * tried in the order of its set. So the search visits a tree of the same
+ * size, and reaches the same solutions, but not always in the same order.
+ */
+class DancingCellsEngine {
+public:
+  // load() sets up the engine to search the given problem.
+  void load(const SearchInput &input);
+  // start() begins a search of the problem loaded.
+  void start();
+  /* next() resumes the search until it reaches the next solution, returning
+   * false if there are no more.
+   */
+  bool next();
+  /* path() lists, for each level of the solution last reached, the node of
+   * the option chosen there in the list of the item chosen there.
+   */
+  const std::vector<int64_t> &path() const { return chosen_nodes; }
+  uint64_t node_count() const { return nodes_entered; }
+  bool is_at_solution() const { return state == State::at_solution; }
+  // clear() releases the memory of the engine.
+  void clear();
+
+private:
+  enum class State { entering, at_solution, finished };
+
+  /* A cell stands for an item of an option: item is where the set of that
+   * item begins, and loc is the position of the cell in that set. The cells
+   * of each option are followed by a spacer, whose item is -1 and whose loc
+   * is the first cell of the option.
+   */
+  struct Cell {
+    int32_t item;
+    int32_t loc;
+  };
+
+  // POS(i) and SIZE(i) stand just before the set of item i.
+  int32_t &pos(int32_t i) { return set[i - 2]; }
+  int32_t &size(int32_t i) { return set[i - 1]; }
+
+  void deactivate(int32_t i);
+  void hide(int32_t p);
+  void unhide(int32_t p);
+  void cover(int32_t i);
+  void uncover(int32_t i);
+  void cover_other_items(int32_t p);
+  void uncover_other_items(int32_t p);
+
+  std::vector<Cell> cells;
+  // The node of the problem for each cell.
+  std::vector<int64_t> cell_nodes;
+  std::vector<int32_t> set;
+  // The items whose sets begin before second are primary.
+  int32_t second = 0;
+  // The primary items, the first active_count of them active.
+  std::vector<int32_t> active;
+  int32_t active_count = 0;
+  // The item chosen at each level, and the position of the option tried.
+  std::vector<int32_t> chosen_item;
+  std::vector<int32_t> tried;
+  std::vector<int64_t> chosen_nodes;
+  int64_t level = 0;
+  State state = State::finished;
+  uint64_t nodes_entered = 0;
+};
+
+} // namespace algorithm_x
+
+#endif // #define DANCING_CELLS_H
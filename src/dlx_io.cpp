@@ -0,0 +1,670 @@
+#include "algorithm_x.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace algorithm_x {
+
+namespace {
+
+// A MappedFile maps the whole of a file into memory, read only.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path) : data(nullptr), size(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open " + path + ".");
+    }
+    struct stat status;
+    if (fstat(fd, &status) < 0) {
+      close(fd);
+      throw std::runtime_error("Cannot read " + path + ".");
+    }
+    size = status.st_size;
+    if (size > 0) {
+      void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("Cannot map " + path + " into memory.");
+      }
+      data = static_cast<const char *>(mapping);
+      madvise(mapping, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() {
+    if (size > 0) {
+      munmap(const_cast<char *>(data), size);
+    }
+  }
+
+  const char *begin() const { return data; }
+  const char *end() const { return data + size; }
+
+private:
+  const char *data;
+  std::size_t size;
+};
+
+/* next_line() finds the line starting at p, without its line break, and moves
+ * p past it. It returns false at the end of the text.
+ */
+bool next_line(const char *&p, const char *end, std::string_view &line) {
+  if (p == end) {
+    return false;
+  }
+  const char *newline = static_cast<const char *>(memchr(p, '\n', end - p));
+  const char *stop = newline ? newline : end;
+  line = std::string_view(p, stop - p);
+  if (!line.empty() && line.back() == '\r') {
+    line.remove_suffix(1);
+  }
+  p = newline ? newline + 1 : end;
+  return true;
+}
+
+// split() breaks a line into the words separated by spaces or tabs.
+void split(std::string_view line, std::vector<std::string_view> &words) {
+  words.clear();
+  std::size_t k = 0;
+  while (k < line.size()) {
+    while (k < line.size() && (line[k] == ' ' || line[k] == '\t')) {
+      ++k;
+    }
+    std::size_t start = k;
+    while (k < line.size() && line[k] != ' ' && line[k] != '\t') {
+      ++k;
+    }
+    if (k > start) {
+      words.push_back(line.substr(start, k - start));
+    }
+  }
+}
+
+int64_t parse_count(std::string_view text) {
+  int64_t value = 0;
+  auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (text.empty() || result.ec != std::errc() ||
+      result.ptr != text.data() + text.size()) {
+    throw std::invalid_argument("Multiplicities must be written as u:v| or "
+                                "v| before an item.");
+  }
+  return value;
+}
+
+/* A snapshot begins with a SnapshotHeader, and then holds, in order: the
+ * items description; if the options were described, the size of each option
+ * and then their items, and the colors of these if there are any; the length
+ * of each item name and then
+ * their characters, if there are any; the items and the nodes, byte for byte,
+ * and the colors of the nodes if there are any; BOUND and SLACK if there
+ * are multiplicities; and the nodes of the options forced by preprocess().
+ */
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t byte_order;
+  uint32_t index_bytes;
+  int64_t item_count;
+  int64_t primary_count;
+  int64_t option_count;
+  int64_t option_item_count;
+  int64_t name_bytes;
+  int64_t node_count;
+  int64_t forced_count;
+  uint8_t has_string_description;
+  uint8_t has_colors;
+  uint8_t has_names;
+  uint8_t has_bounds;
+  uint8_t has_descriptions;
+  uint8_t is_preprocessed;
+  uint8_t padding[2];
+};
+
+const char snapshot_magic[8] = {'D', 'L', 'X', 'S', 'N', 'A', 'P', '2'};
+const uint32_t snapshot_byte_order = 0x01020304;
+
+/* A checkpoint begins with a CheckpointHeader, and then holds the candidate
+ * stack, x_0, ..., x_{depth-1}, and the solutions stored by solve(), written
+ * as the number of options in each, and the index of each option with the
+ * position of its lead item.
+ * The fingerprint sums up the problem the position belongs to.
+ */
+struct CheckpointHeader {
+  char magic[8];
+  uint32_t byte_order;
+  uint32_t index_bytes;
+  uint64_t fingerprint;
+  uint64_t search_nodes;
+  uint64_t solutions_found;
+  int64_t depth;
+  int64_t root_level;
+  int64_t solution_words;
+  uint8_t is_at_solution;
+  uint8_t padding[7];
+};
+
+const char checkpoint_magic[8] = {'D', 'L', 'X', 'C', 'K', 'P', 'T', '2'};
+
+// mix() adds a value to an FNV-1a hash, a byte at a time.
+void mix(uint64_t &hash, uint64_t value) {
+  for (int k = 0; k < 8; ++k) {
+    hash = (hash ^ (value & 0xff)) * 0x100000001b3;
+    value >>= 8;
+  }
+}
+
+template <typename T>
+void write_array(std::ofstream &out, const T *data, int64_t count) {
+  out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+}
+
+// read_array() copies count elements out of the snapshot at p, and moves p on.
+template <typename T>
+void read_array(const char *&p, const char *end, T *data, int64_t count) {
+  if (count < 0 || (uint64_t)(end - p) < count * sizeof(T)) {
+    throw std::runtime_error("The snapshot is truncated.");
+  }
+  if (count > 0) {
+    memcpy(static_cast<void *>(data), p, count * sizeof(T));
+  }
+  p += count * sizeof(T);
+}
+
+} // namespace
+
+template <typename Index>
+BasicExactCoverProblem<Index>
+BasicExactCoverProblem<Index>::read_dlx(const std::string &path) {
+  MappedFile file(path);
+  const char *p = file.begin();
+  const char *end = file.end();
+  BasicExactCoverProblem problem;
+  // Names are looked up as views into the mapped file.
+  std::unordered_map<std::string_view, int64_t> item_index;
+  std::unordered_map<std::string_view, int64_t> color_index;
+  std::vector<std::string_view> words;
+  std::string_view line;
+
+  // The first line that is not a comment names the items.
+  do {
+    if (!next_line(p, end, line)) {
+      throw std::invalid_argument("A DLX file must begin with a line naming "
+                                  "its items.");
+    }
+  } while (!line.empty() && line[0] == '|');
+  split(line, words);
+  bool is_secondary = false;
+  bool has_bounds = false;
+  std::vector<int64_t> lower;
+  std::vector<int64_t> upper;
+  for (std::string_view name : words) {
+    if (name == "|") {
+      if (is_secondary) {
+        throw std::invalid_argument("Only one | may separate the primary "
+                                    "items from the secondary ones.");
+      }
+      is_secondary = true;
+      continue;
+    }
+    int64_t u = 1;
+    int64_t v = 1;
+    std::size_t bar = name.find('|');
+    if (bar != std::string_view::npos) {
+      if (is_secondary) {
+        throw std::invalid_argument("Only primary items have multiplicities.");
+      }
+      std::string_view counts = name.substr(0, bar);
+      std::size_t colon = counts.find(':');
+      if (colon == std::string_view::npos) {
+        u = v = parse_count(counts);
+      } else {
+        u = parse_count(counts.substr(0, colon));
+        v = parse_count(counts.substr(colon + 1));
+      }
+      name.remove_prefix(bar + 1);
+      has_bounds = true;
+    }
+    if (name.empty() || name.find_first_of(":|") != std::string_view::npos) {
+      throw std::invalid_argument("Item names cannot contain : or |.");
+    }
+    int64_t i = problem.items_description.size() + 1;
+    if (!item_index.emplace(name, i).second) {
+      throw std::invalid_argument("Items must have distinct names.");
+    }
+    problem.items_description.push_back(i);
+    problem.item_names.emplace_back(name);
+    if (!is_secondary) {
+      ++problem.primary_count;
+      lower.push_back(u);
+      upper.push_back(v);
+    }
+  }
+  if (problem.items_description.empty()) {
+    throw std::invalid_argument("A DLX file must name at least one item.");
+  }
+
+  // Each line after it is an option.
+  std::vector<std::pair<int64_t, int64_t>> option;
+  while (next_line(p, end, line)) {
+    if (!line.empty() && line[0] == '|') {
+      continue;
+    }
+    split(line, words);
+    if (words.empty()) {
+      continue;
+    }
+    option.clear();
+    for (std::string_view word : words) {
+      std::size_t colon = word.find(':');
+      int64_t color = 0;
+      if (colon != std::string_view::npos) {
+        std::string_view color_name = word.substr(colon + 1);
+        if (color_name.empty()) {
+          throw std::invalid_argument("A colon must be followed by a color.");
+        }
+        color = color_index.emplace(color_name, color_index.size() + 1)
+                    .first->second;
+        word = word.substr(0, colon);
+      }
+      auto found = item_index.find(word);
+      if (found == item_index.end()) {
+        throw std::invalid_argument("Option items must be known.");
+      }
+      if (color != 0 && found->second <= problem.primary_count) {
+        throw std::invalid_argument("Only secondary items can have colors.");
+      }
+      option.emplace_back(found->second, color);
+    }
+    problem.options_description.emplace_back();
+    std::vector<int64_t> &items = problem.options_description.back();
+    items.reserve(option.size());
+    bool has_colors = false;
+    for (const std::pair<int64_t, int64_t> &entry : option) {
+      items.push_back(entry.first);
+      has_colors = has_colors || entry.second != 0;
+    }
+    if (has_colors && problem.colors_description.empty()) {
+      // The options before the first color have none.
+      int64_t k = problem.options_description.size() - 1;
+      problem.colors_description.resize(k);
+      for (k = k - 1; k >= 0; --k) {
+        problem.colors_description[k].assign(
+            problem.options_description[k].size(), 0);
+      }
+    }
+    if (!problem.colors_description.empty()) {
+      problem.colors_description.emplace_back();
+      for (const std::pair<int64_t, int64_t> &entry : option) {
+        problem.colors_description.back().push_back(entry.second);
+      }
+    }
+  }
+  if (problem.options_description.empty()) {
+    throw std::invalid_argument("A DLX file must list at least one option.");
+  }
+
+  problem.initialize_problem();
+  if (has_bounds) {
+    problem.set_multiplicities(lower, upper);
+  }
+  return problem;
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::write_snapshot(const std::string &path) {
+  // The links must be saved as they are before any search.
+  unwind();
+  search_state = SearchState::finished;
+
+  SnapshotHeader header = {};
+  memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+  header.byte_order = snapshot_byte_order;
+  header.index_bytes = sizeof(Index);
+  header.item_count = items_description.size();
+  header.primary_count = primary_count;
+  header.option_count = option_count();
+  header.option_item_count =
+      nodes.size() - items_description.size() - option_count() - 2;
+  header.node_count = nodes.size();
+  header.has_string_description = has_string_description;
+  header.has_colors = !node_colors.empty();
+  header.has_descriptions = !options_description.empty();
+  header.has_names = !item_names.empty();
+  header.has_bounds = !bound.empty();
+  header.forced_count = forced.size();
+  header.is_preprocessed = preprocessed;
+  std::vector<int64_t> name_lengths;
+  for (const std::string &name : item_names) {
+    name_lengths.push_back(name.size());
+    header.name_bytes += name.size();
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Cannot open " + path + ".");
+  }
+  write_array(out, &header, 1);
+  write_array(out, items_description.data(), items_description.size());
+  std::vector<int64_t> option_sizes;
+  option_sizes.reserve(options_description.size());
+  for (const std::vector<int64_t> &option : options_description) {
+    option_sizes.push_back(option.size());
+  }
+  write_array(out, option_sizes.data(), option_sizes.size());
+  for (const std::vector<int64_t> &option : options_description) {
+    write_array(out, option.data(), option.size());
+  }
+  for (const std::vector<int64_t> &colors : colors_description) {
+    write_array(out, colors.data(), colors.size());
+  }
+  write_array(out, name_lengths.data(), name_lengths.size());
+  for (const std::string &name : item_names) {
+    write_array(out, name.data(), name.size());
+  }
+  write_array(out, items.data(), items.size());
+  write_array(out, nodes.data(), nodes.size());
+  write_array(out, node_colors.data(), node_colors.size());
+  write_array(out, bound.data(), bound.size());
+  write_array(out, slack.data(), slack.size());
+  write_array(out, forced.data(), forced.size());
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Cannot write " + path + ".");
+  }
+}
+
+template <typename Index>
+BasicExactCoverProblem<Index>
+BasicExactCoverProblem<Index>::read_snapshot(const std::string &path) {
+  MappedFile file(path);
+  const char *p = file.begin();
+  const char *end = file.end();
+  BasicExactCoverProblem problem;
+
+  SnapshotHeader header;
+  read_array(p, end, &header, 1);
+  if (memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0) {
+    throw std::runtime_error(path + " is not a snapshot.");
+  }
+  if (header.byte_order != snapshot_byte_order ||
+      header.index_bytes != sizeof(Index)) {
+    throw std::runtime_error("The snapshot was written with another byte "
+                             "order or width of links.");
+  }
+  int64_t n = header.item_count;
+  if (n < 0 || header.primary_count < 0 || header.primary_count > n ||
+      header.option_count < 0 || header.forced_count < 0 ||
+      header.node_count != n + header.option_count +
+                               header.option_item_count + 2) {
+    throw std::runtime_error("The snapshot is corrupt.");
+  }
+  problem.has_string_description = header.has_string_description;
+  problem.primary_count = header.primary_count;
+  problem.items_description.resize(n);
+  read_array(p, end, problem.items_description.data(), n);
+
+  if (header.has_descriptions) {
+    std::vector<int64_t> option_sizes(header.option_count);
+    read_array(p, end, option_sizes.data(), header.option_count);
+    int64_t option_item_count = 0;
+    for (int64_t size : option_sizes) {
+      if (size < 0) {
+        throw std::runtime_error("The snapshot is corrupt.");
+      }
+      option_item_count += size;
+    }
+    if (option_item_count != header.option_item_count) {
+      throw std::runtime_error("The snapshot is corrupt.");
+    }
+    problem.options_description.resize(header.option_count);
+    for (int64_t k = 0; k < header.option_count; ++k) {
+      problem.options_description[k].resize(option_sizes[k]);
+      read_array(p, end, problem.options_description[k].data(),
+                 option_sizes[k]);
+    }
+    if (header.has_colors) {
+      problem.colors_description.resize(header.option_count);
+      for (int64_t k = 0; k < header.option_count; ++k) {
+        problem.colors_description[k].resize(option_sizes[k]);
+        read_array(p, end, problem.colors_description[k].data(),
+                   option_sizes[k]);
+      }
+    }
+  }
+  if (header.has_names) {
+    std::vector<int64_t> name_lengths(n);
+    read_array(p, end, name_lengths.data(), n);
+    problem.item_names.resize(n);
+    for (int64_t i = 0; i < n; ++i) {
+      if (name_lengths[i] < 0) {
+        throw std::runtime_error("The snapshot is corrupt.");
+      }
+      problem.item_names[i].resize(name_lengths[i]);
+      read_array(p, end, &problem.item_names[i][0], name_lengths[i]);
+    }
+  }
+
+  // The links are copied in as they were written.
+  problem.items.resize(n + 2);
+  read_array(p, end, problem.items.data(), n + 2);
+  problem.nodes.resize(header.node_count);
+  read_array(p, end, problem.nodes.data(), header.node_count);
+  if (header.has_colors) {
+    problem.node_colors.resize(header.node_count);
+    read_array(p, end, problem.node_colors.data(), header.node_count);
+    problem.last_plain_item = problem.primary_count;
+  } else {
+    problem.last_plain_item = n;
+  }
+  if (header.has_bounds) {
+    problem.bound.resize(problem.primary_count + 1);
+    problem.slack.resize(problem.primary_count + 1);
+    read_array(p, end, problem.bound.data(), problem.primary_count + 1);
+    read_array(p, end, problem.slack.data(), problem.primary_count + 1);
+    problem.first_tweak.resize(header.option_count + problem.primary_count +
+                               1);
+    problem.candidate.reserve(header.option_count + problem.primary_count);
+  }
+  problem.forced.resize(header.forced_count);
+  read_array(p, end, problem.forced.data(), header.forced_count);
+  for (Index x : problem.forced) {
+    if (x <= n || x >= header.node_count) {
+      throw std::runtime_error("The snapshot is corrupt.");
+    }
+  }
+  problem.initialize_search();
+  problem.preprocessed = header.is_preprocessed;
+  return problem;
+}
+
+/* fingerprint() hashes what a search position depends on and the search
+ * never changes: the items and the nodes of each option, the options forced
+ * by preprocess(), and the multiplicities. It does not depend on the width of
+ * the links, so that jobs can be shared between the two.
+ */
+template <typename Index>
+uint64_t BasicExactCoverProblem<Index>::fingerprint() const {
+  uint64_t hash = 0xcbf29ce484222325;
+  mix(hash, items_description.size());
+  mix(hash, primary_count);
+  mix(hash, nodes.size());
+  for (Index x = items_description.size() + 1; x < (Index)nodes.size(); ++x) {
+    mix(hash, nodes[x].top);
+  }
+  mix(hash, preprocessed);
+  for (Index x : forced) {
+    mix(hash, x);
+  }
+  mix(hash, bound.size());
+  for (Index s : slack) {
+    mix(hash, s);
+  }
+  return hash;
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::checkpoint(const std::string &path) {
+  // The position of another engine is saved as that of the dancing links.
+  leave_engine_search();
+  if (work_queue != nullptr || (search_state != SearchState::enter_level &&
+                                search_state != SearchState::leave_level)) {
+    throw std::logic_error("Only a search paused on one thread can be "
+                           "checkpointed.");
+  }
+  std::vector<int64_t> words;
+  for (int64_t k = 0; k < solutions.size(); ++k) {
+    words.push_back(solutions.length(k));
+    for (int64_t m = 0; m < solutions.length(k); ++m) {
+      words.push_back(solutions.options(k)[m]);
+      words.push_back(solutions.leads(k)[m]);
+    }
+  }
+  CheckpointHeader header = {};
+  memcpy(header.magic, checkpoint_magic, sizeof(header.magic));
+  header.byte_order = snapshot_byte_order;
+  header.index_bytes = sizeof(Index);
+  header.fingerprint = fingerprint();
+  header.search_nodes = search_nodes;
+  header.solutions_found = solutions_found;
+  header.depth = candidate.size();
+  header.root_level = root_level;
+  header.solution_words = words.size();
+  header.is_at_solution = search_state == SearchState::leave_level;
+
+  /* The checkpoint is written in full before it takes the place of the last
+   * one, so that there is always a whole one to resume from.
+   */
+  std::string part = path + ".part";
+  std::ofstream out(part, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Cannot open " + part + ".");
+  }
+  write_array(out, &header, 1);
+  write_array(out, candidate.data(), candidate.size());
+  write_array(out, words.data(), words.size());
+  out.close();
+  if (!out || std::rename(part.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("Cannot write " + path + ".");
+  }
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::resume(const std::string &path) {
+  MappedFile file(path);
+  const char *p = file.begin();
+  const char *end = file.end();
+  CheckpointHeader header;
+  read_array(p, end, &header, 1);
+  if (memcmp(header.magic, checkpoint_magic, sizeof(header.magic)) != 0) {
+    throw std::runtime_error(path + " is not a checkpoint.");
+  }
+  if (header.byte_order != snapshot_byte_order ||
+      header.index_bytes != sizeof(Index)) {
+    throw std::runtime_error("The checkpoint was written with another byte "
+                             "order or width of links.");
+  }
+  if (header.fingerprint != fingerprint()) {
+    throw std::runtime_error("The checkpoint was written for another "
+                             "problem.");
+  }
+  int64_t depth = header.depth;
+  if (depth < 0 || depth > option_count() + primary_count ||
+      header.root_level < 0 || header.root_level > depth) {
+    throw std::runtime_error("The checkpoint is corrupt.");
+  }
+  std::vector<Index> path_nodes(depth);
+  read_array(p, end, path_nodes.data(), depth);
+  std::vector<int64_t> words(std::max<int64_t>(header.solution_words, 0));
+  read_array(p, end, words.data(), header.solution_words);
+
+  // Each option must exist, and its lead item must lie within it.
+  std::vector<Index> starts = option_first_nodes();
+  SolutionStore stored;
+  for (std::size_t k = 0; k < words.size();) {
+    int64_t size = words[k++];
+    if (size < 0 || size > (int64_t)(words.size() - k) / 2) {
+      throw std::runtime_error("The checkpoint is corrupt.");
+    }
+    for (int64_t m = 0; m < size; ++m, k += 2) {
+      int64_t option = words[k];
+      int64_t lead = words[k + 1];
+      if (option < 0 || option >= option_count() || lead < 0 ||
+          lead >= starts[option + 1] - 1 - starts[option]) {
+        throw std::runtime_error("The checkpoint is corrupt.");
+      }
+      stored.add_option(option, lead);
+    }
+    stored.end_solution();
+  }
+
+  /* The levels are entered again in order. Each node must belong to a
+   * primary item that is still active, and lie in its list, or under
+   * multiplicities be the item itself.
+   */
+  start_search();
+  search_state = SearchState::finished;
+  Index n = items_description.size();
+  for (Index l = 0; l < depth; ++l) {
+    Index x = path_nodes[l];
+    bool is_item = !bound.empty() && x >= 1 && x <= primary_count;
+    bool is_node = x > n && x < (Index)nodes.size() && nodes[x].top > 0 &&
+                   nodes[x].top <= primary_count;
+    if (!is_item && !is_node) {
+      unwind();
+      throw std::runtime_error("The checkpoint is corrupt.");
+    }
+    Index i = is_item ? x : nodes[x].top;
+    Index y = nodes[i].dlink;
+    while (y != x && y != i) {
+      y = nodes[y].dlink;
+    }
+    if (items[items[i].llink].rlink != i || y != x) {
+      unwind();
+      throw std::runtime_error("The checkpoint does not fit the problem.");
+    }
+    replay_level(x, l, true);
+  }
+  root_level = header.root_level;
+  level = depth;
+  search_state = header.is_at_solution ? SearchState::leave_level
+                                       : SearchState::enter_level;
+  solutions = std::move(stored);
+  solved = false;
+  resume_pending = true;
+  resume_nodes = header.search_nodes;
+  resume_solutions = header.solutions_found;
+}
+
+template BasicExactCoverProblem<int32_t>
+BasicExactCoverProblem<int32_t>::read_dlx(const std::string &);
+template BasicExactCoverProblem<int64_t>
+BasicExactCoverProblem<int64_t>::read_dlx(const std::string &);
+template void
+BasicExactCoverProblem<int32_t>::write_snapshot(const std::string &);
+template void
+BasicExactCoverProblem<int64_t>::write_snapshot(const std::string &);
+template BasicExactCoverProblem<int32_t>
+BasicExactCoverProblem<int32_t>::read_snapshot(const std::string &);
+template BasicExactCoverProblem<int64_t>
+BasicExactCoverProblem<int64_t>::read_snapshot(const std::string &);
+template void BasicExactCoverProblem<int32_t>::checkpoint(const std::string &);
+template void BasicExactCoverProblem<int64_t>::checkpoint(const std::string &);
+template void BasicExactCoverProblem<int32_t>::resume(const std::string &);
+template void BasicExactCoverProblem<int64_t>::resume(const std::string &);
+
+} // namespace algorithm_x
@@ -0,0 +1,177 @@
+#include "exact_cover_builder.h"
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace algorithm_x {
+
+template <typename Index>
+BasicExactCoverBuilder<Index>::BasicExactCoverBuilder(bool keep_options)
+    : keep_options(keep_options), primary_count(0),
+      has_secondary_items(false), options(0), checks(0) {}
+
+template <typename Index>
+void BasicExactCoverBuilder<Index>::reserve(int64_t item_count,
+                                            int64_t option_count,
+                                            int64_t option_item_count) {
+  items_description.reserve(item_count);
+  nodes.reserve(item_count + option_count + option_item_count + 2);
+  if (keep_options) {
+    options_description.reserve(option_count);
+  }
+}
+
+template <typename Index>
+int64_t BasicExactCoverBuilder<Index>::add_item(int64_t name) {
+  if (has_secondary_items) {
+    throw std::logic_error("Primary items must come before secondary ones.");
+  }
+  add_name(name);
+  ++primary_count;
+  return items_description.size();
+}
+
+template <typename Index>
+int64_t BasicExactCoverBuilder<Index>::add_secondary_item(int64_t name) {
+  add_name(name);
+  has_secondary_items = true;
+  return items_description.size();
+}
+
+template <typename Index>
+void BasicExactCoverBuilder<Index>::add_name(int64_t name) {
+  if (!nodes.empty()) {
+    throw std::logic_error("Items must all be added before any option.");
+  }
+  items_description.push_back(name);
+}
+
+/* lay_out_items() places the header and the heads of the item lists, which
+ * come first among the nodes, and the spacer before the first option.
+ */
+template <typename Index>
+void BasicExactCoverBuilder<Index>::lay_out_items() {
+  Index n = items_description.size();
+  push_node(0, 0, 0, 0);
+  for (Index i = 1; i <= n; ++i) {
+    push_node(0, i, i, 0);
+  }
+  push_node(0, 0, 0, 0);
+  seen_in.assign(n + 1, 0);
+}
+
+template <typename Index>
+void BasicExactCoverBuilder<Index>::push_node(Index top, Index ulink,
+                                              Index dlink, Index color) {
+  if (nodes.size() >= (uint64_t)std::numeric_limits<Index>::max()) {
+    throw std::length_error("Problem instance has too many nodes "
+                            "for the index type of its links.");
+  }
+  nodes.push_back({top, ulink, dlink});
+  if (!node_colors.empty()) {
+    node_colors.push_back(color);
+  }
+}
+
+template <typename Index>
+int64_t BasicExactCoverBuilder<Index>::add_option(const int64_t *option_items,
+                                                  int64_t size,
+                                                  const int64_t *colors) {
+  if (nodes.empty()) {
+    lay_out_items();
+  }
+  Index n = items_description.size();
+  // Check the whole option first, so that a bad one leaves no trace.
+  ++checks;
+  bool has_colors = false;
+  for (int64_t m = 0; m < size; ++m) {
+    int64_t i = option_items[m];
+    if (i < 1 || i > n) {
+      throw std::invalid_argument("Option items must be known.");
+    }
+    if (seen_in[i] == checks) {
+      throw std::invalid_argument("An option cannot list an item twice.");
+    }
+    seen_in[i] = checks;
+    if (colors != nullptr && colors[m] != 0) {
+      if (colors[m] < 0) {
+        throw std::invalid_argument("Colors must be positive.");
+      }
+      if (i <= primary_count) {
+        throw std::invalid_argument("Only secondary items can have colors.");
+      }
+      has_colors = true;
+    }
+  }
+  if (has_colors && node_colors.empty()) {
+    // The nodes before the first color have none.
+    node_colors.assign(nodes.size(), 0);
+  }
+
+  /* As in Knuth (p. 67), the spacer before an option links down to its last
+   * node, and the spacer after it up to its first node. Each node joins the
+   * bottom of the list of its item.
+   */
+  ++options;
+  Index spacer = nodes.size() - 1;
+  for (int64_t m = 0; m < size; ++m) {
+    Index i = option_items[m];
+    Index x = nodes.size();
+    push_node(i, nodes[i].ulink, i, colors != nullptr ? colors[m] : 0);
+    nodes[nodes[i].ulink].dlink = x;
+    nodes[i].ulink = x;
+    ++nodes[i].top;
+  }
+  nodes[spacer].dlink = nodes.size() - 1;
+  push_node(-options, spacer + 1, 0, 0);
+
+  if (keep_options) {
+    options_description.emplace_back();
+    std::vector<int64_t> &option = options_description.back();
+    option.reserve(size);
+    for (int64_t m = 0; m < size; ++m) {
+      option.push_back(items_description[option_items[m] - 1]);
+    }
+    if (!node_colors.empty()) {
+      if (colors_description.empty()) {
+        colors_description.resize(options - 1);
+        for (Index k = 0; k < options - 1; ++k) {
+          colors_description[k].assign(options_description[k].size(), 0);
+        }
+      }
+      colors_description.emplace_back(size, 0);
+      if (colors != nullptr) {
+        colors_description.back().assign(colors, colors + size);
+      }
+    }
+  }
+  return options - 1;
+}
+
+template <typename Index>
+BasicExactCoverProblem<Index> BasicExactCoverBuilder<Index>::build() {
+  if (nodes.empty()) {
+    lay_out_items();
+  }
+  Problem problem;
+  problem.primary_count = primary_count;
+  problem.items_description = std::move(items_description);
+  problem.options_description = std::move(options_description);
+  problem.colors_description = std::move(colors_description);
+  problem.nodes = std::move(nodes);
+  problem.node_colors = std::move(node_colors);
+  problem.last_plain_item = problem.node_colors.empty()
+                                ? (Index)problem.items_description.size()
+                                : primary_count;
+  problem.initialize_items();
+  problem.initialize_search();
+  *this = BasicExactCoverBuilder(keep_options);
+  return problem;
+}
+
+template class BasicExactCoverBuilder<int32_t>;
+template class BasicExactCoverBuilder<int64_t>;
+
+} // namespace algorithm_x
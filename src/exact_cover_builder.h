@@ -0,0 +1,83 @@
+#ifndef EXACT_COVER_BUILDER_H
+#define EXACT_COVER_BUILDER_H
+
+#include "algorithm_x.h"
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace algorithm_x {
+
+/* A BasicExactCoverBuilder builds a problem one item and one option at a time,
+ * writing each option straight into the nodes of the finished problem rather
+ * than into a description to be copied and linked afterwards. All of the items
+ * must be added before any option, and the primary ones before the secondary
+ * ones; add_item() returns the number by which options refer to an item, which
+ * counts up from 1. For example,
+ *   ExactCoverBuilder builder;
+ *   int64_t a = builder.add_item('a'), b = builder.add_item('b');
+ *   builder.add_option({a, b});
+ *   ExactCoverProblem problem = builder.build();
+ *
+ * A builder made with keep_options false does not keep the items of each
+ * option apart from its nodes. The problem it builds reports its solutions
+ * just as well, by reading them back from the nodes, but it cannot be saved to
+ * a snapshot with its options described.
+ */
+template <typename Index> class BasicExactCoverBuilder {
+public:
+  explicit BasicExactCoverBuilder(bool keep_options = true);
+
+  /* reserve() makes room for the given numbers of items, options, and items
+   * of all options together, so that nothing need be moved as they are added.
+   */
+  void reserve(int64_t item_count, int64_t option_count,
+               int64_t option_item_count);
+  int64_t add_item(int64_t name);
+  int64_t add_secondary_item(int64_t name);
+  /* add_option() adds an option of the given items, in any order, and returns
+   * its index. Each may be given a color, as in
+   * BasicExactCoverProblem's constructors, or 0 for none; colors may be null
+   * if none is.
+   */
+  int64_t add_option(const int64_t *option_items, int64_t size,
+                     const int64_t *colors = nullptr);
+  int64_t add_option(std::initializer_list<int64_t> option_items) {
+    return add_option(option_items.begin(), option_items.size());
+  }
+  int64_t add_option(const std::vector<int64_t> &option_items) {
+    return add_option(option_items.data(), option_items.size());
+  }
+  // build() hands the nodes over to the problem, leaving the builder empty.
+  BasicExactCoverProblem<Index> build();
+
+private:
+  using Problem = BasicExactCoverProblem<Index>;
+
+  void add_name(int64_t name);
+  void lay_out_items();
+  void push_node(Index top, Index ulink, Index dlink, Index color);
+
+  bool keep_options;
+  std::vector<int64_t> items_description;
+  Index primary_count;
+  bool has_secondary_items;
+  std::vector<std::vector<int64_t>> options_description;
+  std::vector<std::vector<int64_t>> colors_description;
+  std::vector<typename Problem::Node> nodes;
+  // node_colors is empty until some option has a color.
+  std::vector<Index> node_colors;
+  Index options;
+  /* seen_in[i] is the last check of an option, counted by checks, to find
+   * item i in it.
+   */
+  int64_t checks;
+  std::vector<int64_t> seen_in;
+};
+
+using ExactCoverBuilder = BasicExactCoverBuilder<int64_t>;
+using CompactExactCoverBuilder = BasicExactCoverBuilder<int32_t>;
+
+} // namespace algorithm_x
+
+#endif // #define EXACT_COVER_BUILDER_H
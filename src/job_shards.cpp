@@ -0,0 +1,385 @@
+#include "job_shards.h"
+#include "algorithm_x.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace algorithm_x {
+
+namespace {
+
+/* A jobs file begins with the line
+ *   | jobs J depth D nodes N fingerprint F
+ * and then gives each job a line of its own, holding the number of levels of
+ * its prefix and then the index of the option chosen at each of them. N is
+ * the number of nodes of the tree above the jobs, and F, in hexadecimal, is
+ * the fingerprint of the problem.
+ *
+ * A result file begins with the line
+ *   | job K of J fingerprint F listed L
+ * then, if L is 1, lists the solutions of job K, one to a line as the indices
+ * of their options, and ends with the line
+ *   | nodes N solutions S
+ * which run_job() writes only once the job is done.
+ */
+
+/* read_fields() reads a line of the form "| key value key value ...", which
+ * must have the given keys in order, into values. A fingerprint is read in
+ * hexadecimal, and the other values in decimal. It returns false if the line
+ * has some other form.
+ */
+bool read_fields(const std::string &line, const std::vector<std::string> &keys,
+                 std::vector<uint64_t> &values) {
+  std::istringstream words(line);
+  std::string word;
+  if (!(words >> word) || word != "|") {
+    return false;
+  }
+  values.clear();
+  for (const std::string &key : keys) {
+    std::string value;
+    if (!(words >> word >> value) || word != key || value[0] == '-') {
+      return false;
+    }
+    try {
+      std::size_t used = 0;
+      int base = key == "fingerprint" ? 16 : 10;
+      values.push_back(std::stoull(value, &used, base));
+      if (used != value.size()) {
+        return false;
+      }
+    } catch (const std::logic_error &) {
+      return false;
+    }
+  }
+  return !(words >> word);
+}
+
+struct JobsHeader {
+  int64_t jobs;
+  int64_t depth;
+  uint64_t nodes;
+  uint64_t fingerprint;
+};
+
+JobsHeader read_jobs_header(std::istream &in, const std::string &path) {
+  std::string line;
+  std::vector<uint64_t> values;
+  if (!std::getline(in, line) ||
+      !read_fields(line, {"jobs", "depth", "nodes", "fingerprint"}, values)) {
+    throw std::runtime_error(path + " is not a jobs file.");
+  }
+  return JobsHeader{(int64_t)values[0], (int64_t)values[1], values[2],
+                    values[3]};
+}
+
+struct ResultHeader {
+  int64_t job;
+  int64_t jobs;
+  uint64_t fingerprint;
+  bool is_listed;
+};
+
+ResultHeader read_result_header(std::istream &in, const std::string &path) {
+  std::string line;
+  std::vector<uint64_t> values;
+  if (!std::getline(in, line) ||
+      !read_fields(line, {"job", "of", "fingerprint", "listed"}, values) ||
+      values[3] > 1) {
+    throw std::runtime_error(path + " is not a job result.");
+  }
+  return ResultHeader{(int64_t)values[0], (int64_t)values[1], values[2],
+                      values[3] == 1};
+}
+
+} // namespace
+
+template <typename Index>
+int64_t BasicExactCoverProblem<Index>::write_jobs(const std::string &path,
+                                                  int64_t depth) {
+  if (!bound.empty()) {
+    throw std::logic_error("Jobs cannot be made under multiplicities.");
+  }
+  if (depth < 0) {
+    throw std::invalid_argument("The depth of the jobs cannot be negative.");
+  }
+  start_search();
+  search_state = SearchState::finished;
+
+  /* The first depth levels are searched as by Algorithm X, except that the
+   * node at which a job begins is listed rather than entered, whether it is
+   * at level depth or is a solution higher up. The jobs are listed in the
+   * order in which the search reaches them, and the nodes above them are
+   * counted, dead ends included.
+   */
+  std::ostringstream jobs;
+  int64_t job_count = 0;
+  uint64_t tree_nodes = 0;
+  Index l = 0;
+  Index i;
+
+enter_level:
+  if (l == depth || items[0].rlink == 0) {
+    jobs << l;
+    for (Index m = 0; m < l; ++m) {
+      jobs << ' ' << option_of(candidate[m]);
+    }
+    jobs << '\n';
+    ++job_count;
+    goto leave_level;
+  }
+  ++tree_nodes;
+  i = choose_item_to_cover();
+  cover(i);
+  candidate.push_back(nodes[i].dlink);
+
+try_option:
+  if (candidate[l] == i) {
+    uncover(i);
+    candidate.pop_back();
+    goto leave_level;
+  }
+  cover_other_items(candidate[l]);
+  ++l;
+  goto enter_level;
+
+leave_level:
+  if (l > 0) {
+    --l;
+    uncover_other_items(candidate[l]);
+    i = nodes[candidate[l]].top;
+    candidate[l] = nodes[candidate[l]].dlink;
+    goto try_option;
+  }
+
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Cannot open " + path + ".");
+  }
+  out << "| jobs " << job_count << " depth " << depth << " nodes "
+      << tree_nodes << " fingerprint " << std::hex << fingerprint()
+      << std::dec << '\n'
+      << jobs.str();
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Cannot write " + path + ".");
+  }
+  return job_count;
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::load_job(const std::string &path,
+                                             int64_t job) {
+  if (!bound.empty()) {
+    throw std::logic_error("Jobs cannot be run under multiplicities.");
+  }
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Cannot open " + path + ".");
+  }
+  JobsHeader header = read_jobs_header(in, path);
+  if (header.fingerprint != fingerprint()) {
+    throw std::runtime_error("The jobs were made for another problem.");
+  }
+  if (job < 0 || job >= header.jobs) {
+    throw std::invalid_argument("There is no job " + std::to_string(job) +
+                                " in " + path + ".");
+  }
+  std::string line;
+  for (int64_t k = 0; k <= job; ++k) {
+    if (!std::getline(in, line)) {
+      throw std::runtime_error(path + " is truncated.");
+    }
+  }
+  std::istringstream words(line);
+  int64_t depth = -1;
+  if (!(words >> depth) || depth < 0 || depth > header.depth) {
+    throw std::runtime_error(path + " is corrupt.");
+  }
+  std::vector<int64_t> prefix(depth);
+  for (int64_t &k : prefix) {
+    if (!(words >> k)) {
+      throw std::runtime_error(path + " is corrupt.");
+    }
+  }
+
+  /* Each level chooses its item as the search would, and then the node of
+   * the listed option in the list of that item.
+   */
+  start_search();
+  search_state = SearchState::finished;
+  for (Index l = 0; l < depth; ++l) {
+    Index i = items[0].rlink == 0 ? 0 : choose_item_to_cover();
+    Index x = i == 0 ? 0 : nodes[i].dlink;
+    while (x != i && option_of(x) != prefix[l]) {
+      x = nodes[x].dlink;
+    }
+    if (x == i) {
+      unwind();
+      throw std::runtime_error("The job does not fit the problem.");
+    }
+    replay_level(x, l, true);
+  }
+  root_level = depth;
+  level = depth;
+  search_state = SearchState::enter_level;
+  solutions.clear();
+  solved = false;
+  resume_pending = true;
+  resume_nodes = 0;
+  resume_solutions = 0;
+}
+
+template <typename Index>
+uint64_t BasicExactCoverProblem<Index>::run_job(const std::string &jobs_path,
+                                                int64_t job,
+                                                const std::string &result_path,
+                                                bool list_solutions) {
+  std::ifstream in(jobs_path);
+  if (!in) {
+    throw std::runtime_error("Cannot open " + jobs_path + ".");
+  }
+  JobsHeader header = read_jobs_header(in, jobs_path);
+  load_job(jobs_path, job);
+
+  // The result takes the place of any earlier one only once it is whole.
+  std::string part = result_path + ".part";
+  std::ofstream out(part, std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Cannot open " + part + ".");
+  }
+  out << "| job " << job << " of " << header.jobs << " fingerprint "
+      << std::hex << header.fingerprint << std::dec << " listed "
+      << list_solutions << '\n';
+  uint64_t count = 0;
+  if (list_solutions) {
+    for (const SolutionView &solution : enumerate()) {
+      for (int64_t m = 0; m < solution.size(); ++m) {
+        out << (m > 0 ? " " : "") << solution[m];
+      }
+      out << '\n';
+      ++count;
+    }
+  } else {
+    count = count_solutions();
+  }
+  if (status != SearchStatus::complete) {
+    out.close();
+    std::remove(part.c_str());
+    throw std::runtime_error("Job " + std::to_string(job) +
+                             " was stopped before it was done.");
+  }
+  out << "| nodes " << search_nodes << " solutions " << count << '\n';
+  out.close();
+  if (!out || std::rename(part.c_str(), result_path.c_str()) != 0) {
+    throw std::runtime_error("Cannot write " + result_path + ".");
+  }
+  return count;
+}
+
+JobSummary merge_job_results(const std::string &jobs_path,
+                             const std::vector<std::string> &result_paths,
+                             const std::string &solutions_path) {
+  std::ifstream jobs_in(jobs_path);
+  if (!jobs_in) {
+    throw std::runtime_error("Cannot open " + jobs_path + ".");
+  }
+  JobsHeader header = read_jobs_header(jobs_in, jobs_path);
+
+  // Each job must have exactly one result, made for the same problem.
+  std::vector<std::string> results(header.jobs);
+  for (const std::string &path : result_paths) {
+    std::ifstream in(path);
+    if (!in) {
+      throw std::runtime_error("Cannot open " + path + ".");
+    }
+    ResultHeader result = read_result_header(in, path);
+    if (result.jobs != header.jobs ||
+        result.fingerprint != header.fingerprint || result.job < 0 ||
+        result.job >= header.jobs) {
+      throw std::runtime_error(path + " is not a result of the jobs in " +
+                               jobs_path + ".");
+    }
+    if (!results[result.job].empty()) {
+      throw std::runtime_error("Job " + std::to_string(result.job) +
+                               " has two results.");
+    }
+    results[result.job] = path;
+  }
+  for (int64_t k = 0; k < header.jobs; ++k) {
+    if (results[k].empty()) {
+      throw std::runtime_error("Job " + std::to_string(k) +
+                               " has no result.");
+    }
+  }
+
+  std::ofstream solutions_out;
+  if (!solutions_path.empty()) {
+    solutions_out.open(solutions_path, std::ios::trunc);
+    if (!solutions_out) {
+      throw std::runtime_error("Cannot open " + solutions_path + ".");
+    }
+  }
+  JobSummary summary;
+  summary.jobs = header.jobs;
+  summary.nodes = header.nodes;
+  for (int64_t k = 0; k < header.jobs; ++k) {
+    std::ifstream in(results[k]);
+    ResultHeader result = read_result_header(in, results[k]);
+    if (!result.is_listed && !solutions_path.empty()) {
+      throw std::runtime_error("Job " + std::to_string(k) +
+                               " did not list its solutions.");
+    }
+    std::string line;
+    std::vector<uint64_t> totals;
+    uint64_t listed = 0;
+    bool is_done = false;
+    while (!is_done && std::getline(in, line)) {
+      if (line.empty() || line[0] != '|') {
+        ++listed;
+        if (!solutions_path.empty()) {
+          solutions_out << line << '\n';
+        }
+      } else if (read_fields(line, {"nodes", "solutions"}, totals)) {
+        is_done = true;
+      } else {
+        throw std::runtime_error(results[k] + " is corrupt.");
+      }
+    }
+    if (!is_done) {
+      throw std::runtime_error("The result of job " + std::to_string(k) +
+                               " is incomplete.");
+    }
+    if (result.is_listed && listed != totals[1]) {
+      throw std::runtime_error(results[k] + " is corrupt.");
+    }
+    summary.nodes += totals[0];
+    summary.solutions += totals[1];
+  }
+  if (!solutions_path.empty()) {
+    solutions_out.close();
+    if (!solutions_out) {
+      throw std::runtime_error("Cannot write " + solutions_path + ".");
+    }
+  }
+  return summary;
+}
+
+template int64_t
+BasicExactCoverProblem<int32_t>::write_jobs(const std::string &, int64_t);
+template int64_t
+BasicExactCoverProblem<int64_t>::write_jobs(const std::string &, int64_t);
+template void BasicExactCoverProblem<int32_t>::load_job(const std::string &,
+                                                        int64_t);
+template void BasicExactCoverProblem<int64_t>::load_job(const std::string &,
+                                                        int64_t);
+template uint64_t BasicExactCoverProblem<int32_t>::run_job(
+    const std::string &, int64_t, const std::string &, bool);
+template uint64_t BasicExactCoverProblem<int64_t>::run_job(
+    const std::string &, int64_t, const std::string &, bool);
+
+} // namespace algorithm_x
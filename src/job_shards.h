@@ -0,0 +1,41 @@
+#ifndef JOB_SHARDS_H
+#define JOB_SHARDS_H
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace algorithm_x {
+
+/* A JobSummary totals the results of the jobs of a sharded enumeration, as
+ * merged by merge_job_results(). Its nodes count the tree above the jobs as
+ * well as their subtrees, so that they add up to the nodes of a search on one
+ * thread.
+ */
+struct JobSummary {
+  int64_t jobs = 0;
+  uint64_t nodes = 0;
+  uint64_t solutions = 0;
+
+  const std::string to_string() const {
+    std::stringstream ss;
+    ss << "jobs: " << jobs << "\nnodes: " << nodes
+       << "\nsolutions: " << solutions << '\n';
+    return ss.str();
+  }
+};
+
+/* merge_job_results() reads the result files written by run_job() for the
+ * jobs listed in jobs_path, given in any order, and checks that each job has
+ * exactly one complete result. If solutions_path is not empty, it writes the
+ * solutions of every job there, in the order of the jobs, which is that of a
+ * search on one thread; the jobs must then have listed their solutions.
+ */
+JobSummary merge_job_results(const std::string &jobs_path,
+                             const std::vector<std::string> &result_paths,
+                             const std::string &solutions_path = "");
+
+} // namespace algorithm_x
+
+#endif // #define JOB_SHARDS_H
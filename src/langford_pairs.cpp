@@ -2,22 +2,25 @@
 #include "algorithm_x.h"
 #include <cstdint>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace algorithm_x {
-LangfordPairsProblem::LangfordPairsProblem(int64_t n) {
+LangfordPairsProblem::LangfordPairsProblem(int64_t n, bool break_symmetry) {
   if ((n - 1) > 1 + (INT64_MAX - 1) / 3) {
     throw std::range_error("Problem instance is too large "
                            "for exact cover problem solver.");
   }
   this->n = n;
+  is_symmetry_broken = break_symmetry;
   initialize();
   this->exact_cover_problem = new ExactCoverProblem(items, options);
   return;
 }
 
-LangfordPairsProblem::~LangfordPairsProblem() {}
+LangfordPairsProblem::~LangfordPairsProblem() { delete exact_cover_problem; }
 
 void LangfordPairsProblem::initialize() {
   /* We represent the n different numbers (each of which appears twice in the
@@ -28,9 +31,23 @@ void LangfordPairsProblem::initialize() {
     items.push_back(i);
   }
 
+  /* Every pairing has a mirror image, reversed slot for slot, which puts
+   * number i in slots 2n + 1 - k and 2n + 1 - j rather than j and k. Only an
+   * even i can be its own mirror image, in slots with j + k = 2n + 1, so for
+   * the largest odd number, n - [n even], Knuth keeps just the options with
+   * j + k < 2n + 1, one of each mirrored pair. That keeps exactly one of each
+   * pairing and its mirror image, and the search does half the work.
+   */
+  int64_t restricted = is_symmetry_broken ? n - (n % 2 == 0) : 0;
+  if (is_symmetry_broken) {
+    symmetry_factor = 2;
+  }
   for (int64_t i = 1; i <= n; ++i) {
     for (int64_t k = i + 2; k <= 2 * n; ++k) {
       int64_t j = k - i - 1;
+      if (i == restricted && j + k >= 2 * n + 1) {
+        break;
+      }
       /* These are the indices of the slots. They are declared here for clarify.
        * The compiler will fold them forward.
        */
@@ -40,8 +57,6 @@ void LangfordPairsProblem::initialize() {
       // Here will just follow the option definition given in Knuth (p. 68).
       option.push_back(s_j);
       option.push_back(s_k);
-      std::cout << "Option size here is emphatically" << option.size()
-                << std::endl;
       options.push_back(option);
     }
   }
@@ -51,5 +66,49 @@ void LangfordPairsProblem::solve(bool find_all_solutions) {
   std::cout << "Solving..." << std::endl;
   this->exact_cover_problem->solve(find_all_solutions);
   std::cout << "Solved!" << std::endl;
+
+  // Each option holds a number and, after it, its two slots.
+  sequences.clear();
+  for (const std::vector<std::vector<int64_t>> &solution :
+       exact_cover_problem->get_solutions()) {
+    std::vector<int64_t> sequence(2 * n);
+    for (const std::vector<int64_t> &option : solution) {
+      int64_t i = 0;
+      for (int64_t item : option) {
+        if (item <= n) {
+          i = item;
+        }
+      }
+      for (int64_t item : option) {
+        if (item > n) {
+          sequence[item - n - 1] = i;
+        }
+      }
+    }
+    sequences.push_back(sequence);
+    if (is_symmetry_broken && find_all_solutions) {
+      sequences.emplace_back(sequence.rbegin(), sequence.rend());
+    }
+  }
+}
+
+const std::string LangfordPairsProblem::solutions_string() {
+  if (sequences.empty()) {
+    return ("The solution set is empty. "
+            "Either it has no solution, "
+            "or you never invoked solve().");
+  }
+  std::stringstream ss;
+  for (int64_t s = 0; s < (int64_t)sequences.size(); ++s) {
+    if (s > 0) {
+      ss << ", ";
+    }
+    ss << "{";
+    for (int64_t m = 0; m < 2 * n; ++m) {
+      ss << (m > 0 ? " " : "") << sequences[s][m];
+    }
+    ss << "}";
+  }
+  return ss.str();
 }
 } // namespace algorithm_x
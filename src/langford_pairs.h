@@ -11,20 +11,30 @@ namespace algorithm_x {
 class LangfordPairsProblem : public XcEquivalentProblem {
 public:
   LangfordPairsProblem() = delete;
-  LangfordPairsProblem(int64_t n);
+  /* Unless break_symmetry is false, the options are restricted so that only
+   * one of each solution and its mirror image is searched for; see
+   * initialize().
+   */
+  LangfordPairsProblem(int64_t n, bool break_symmetry = true);
   LangfordPairsProblem(LangfordPairsProblem &other) = delete;
   LangfordPairsProblem(LangfordPairsProblem &&other) = delete;
   LangfordPairsProblem &operator=(LangfordPairsProblem &other) = delete;
   LangfordPairsProblem &operator=(LangfordPairsProblem &&other) = delete;
   ~LangfordPairsProblem();
 
+  /* solve() finds the pairings, each as the sequence of the 2n numbers in
+   * their slots. Found all together, they include the mirror images of those
+   * the search found.
+   */
   void solve(bool find_all_solutions = true);
   const std::string solutions_string();
 
 private:
   int64_t n;
+  bool is_symmetry_broken;
   std::vector<int64_t> items;
   std::vector<std::vector<int64_t>> options;
+  std::vector<std::vector<int64_t>> sequences;
   void initialize();
 };
 } // namespace algorithm_x
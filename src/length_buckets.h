@@ -0,0 +1,123 @@
+#ifndef LENGTH_BUCKETS_H
+#define LENGTH_BUCKETS_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace algorithm_x {
+
+/**
+ * LengthBuckets sorts the active items by the lengths of their lists, so that
+ * the MRV heuristic need not scan all of them. Bucket L is a bitset of the
+ * items whose lists have length L, for each L below bucket_count; items with
+ * longer lists are not tracked. A second, coarser bitset per bucket marks its
+ * nonzero words, and a single word marks the nonempty buckets, so finding the
+ * first item of the first nonempty bucket takes a few bit scans.
+ *
+ * Since bits are found in order, that item is the first item in the active
+ * list of minimum length, just as the linear scan would find it.
+ */
+class LengthBuckets {
+public:
+  static const int64_t bucket_count = 64;
+
+  LengthBuckets() : words(0), summary_words(0), nonempty(0) {
+    sizes.fill(0);
+  }
+
+  // reset() empties the buckets and sizes them for items 0, ..., n - 1.
+  void reset(int64_t n) {
+    words = (n + 63) / 64;
+    summary_words = (words + 63) / 64;
+    bits.assign(bucket_count * words, 0);
+    summary.assign(bucket_count * summary_words, 0);
+    sizes.fill(0);
+    nonempty = 0;
+  }
+
+  void insert(int64_t item, int64_t len) {
+    if (len < bucket_count) {
+      set(len, item);
+    }
+  }
+
+  void erase(int64_t item, int64_t len) {
+    if (len < bucket_count) {
+      clear(len, item);
+    }
+  }
+
+  // shorten() moves an item whose length has just gone down to len.
+  void shorten(int64_t item, int64_t len) {
+    if (len < bucket_count - 1) {
+      clear(len + 1, item);
+      set(len, item);
+    } else if (len == bucket_count - 1) {
+      set(len, item);
+    }
+  }
+
+  // lengthen() moves an item whose length has just gone up to len.
+  void lengthen(int64_t item, int64_t len) {
+    if (len < bucket_count) {
+      clear(len - 1, item);
+      set(len, item);
+    } else if (len == bucket_count) {
+      clear(len - 1, item);
+    }
+  }
+
+  /* first_shortest() returns the first item of the shortest length, or -1 if
+   * every item is at least bucket_count long.
+   */
+  int64_t first_shortest() const {
+    if (nonempty == 0) {
+      return -1;
+    }
+    int64_t len = __builtin_ctzll(nonempty);
+    const uint64_t *summary_bits = &summary[len * summary_words];
+    int64_t s = 0;
+    while (summary_bits[s] == 0) {
+      ++s;
+    }
+    int64_t w = s * 64 + __builtin_ctzll(summary_bits[s]);
+    return w * 64 + __builtin_ctzll(bits[len * words + w]);
+  }
+
+private:
+  void set(int64_t len, int64_t item) {
+    int64_t w = item / 64;
+    uint64_t &word = bits[len * words + w];
+    if (word == 0) {
+      summary[len * summary_words + w / 64] |= uint64_t(1) << (w % 64);
+    }
+    word |= uint64_t(1) << (item % 64);
+    if (sizes[len]++ == 0) {
+      nonempty |= uint64_t(1) << len;
+    }
+  }
+
+  void clear(int64_t len, int64_t item) {
+    int64_t w = item / 64;
+    uint64_t &word = bits[len * words + w];
+    word &= ~(uint64_t(1) << (item % 64));
+    if (word == 0) {
+      summary[len * summary_words + w / 64] &= ~(uint64_t(1) << (w % 64));
+    }
+    if (--sizes[len] == 0) {
+      nonempty &= ~(uint64_t(1) << len);
+    }
+  }
+
+  int64_t words;         // the number of words in each bucket
+  int64_t summary_words; // the number of summary words for each bucket
+  std::vector<uint64_t> bits;
+  std::vector<uint64_t> summary;
+  std::array<int64_t, bucket_count> sizes;
+  uint64_t nonempty;
+};
+
+} // namespace algorithm_x
+
+#endif // #define LENGTH_BUCKETS_H
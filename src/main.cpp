@@ -23,12 +23,53 @@ int main(int argc, char *argv[]) {
                "(each solution given as a set):\n";
   std::cout << p.solutions_string() << '\n';
 
+  /* Only one of each Langford pairing and its mirror image is searched for,
+   * and the other is filled in afterwards.
+   */
   algorithm_x::LangfordPairsProblem lp{4};
-  lp.solve(false);
-  std::cout
-      << "Solved Langford Pairs problem for n = 7! Here is the solution set "
-         "(each solution given as a set):\n";
-  std::cout << lp.get_exact_cover_problem().solutions_string() << '\n';
+  lp.solve();
+  std::cout << "Solved Langford Pairs problem for n = 4! Here is the solution "
+               "set (each solution given as the numbers in its slots):\n";
+  std::cout << lp.solutions_string() << '\n';
+  algorithm_x::LangfordPairsProblem lp7{7};
+  std::cout << "For n = 7, there are " << lp7.count_solutions()
+            << " pairings.\n";
+
+  // Solutions can also be streamed, each given by the indices of its options.
+  std::cout << "The same solution set, as option indices:";
+  for (const algorithm_x::SolutionView &solution : p.enumerate()) {
+    std::cout << " {";
+    for (int64_t option : solution) {
+      std::cout << ' ' << option;
+    }
+    std::cout << " }";
+  }
+  std::cout << '\n';
+
+  // When only the number of solutions matters, none need be stored.
+  std::cout << "The first problem has " << p.count_solutions()
+            << " solution(s).\n";
+
+  // Random probes estimate the size of a search before it is run.
+  std::cout << "Estimated from 1000 random probes of the first problem:\n"
+            << p.estimate_tree_size(1000).to_string();
+
+  /* Secondary items, listed after the primary ones, may be covered at most
+   * once, or by any number of options that agree on their color (Algorithm C,
+   * (49), p. 87).
+   */
+  algorithm_x::ExactCoverProblem c{
+      "pqr", "xy",
+      std::vector<std::string>{"pqxy:A", "prx:Ay", "px:B", "qx:A", "ry:B"}};
+  c.solve();
+  std::cout << "Solved a problem with colors! Here is the solution set:\n";
+  std::cout << c.solutions_string() << '\n';
+
+  // A build made by `make stats` also reports how the search went.
+  if (algorithm_x::SearchStatistics::enabled) {
+    std::cout << "Statistics of the last search:\n";
+    std::cout << c.statistics().to_string();
+  }
 
   return 0;
 }
@@ -0,0 +1,153 @@
+#include "algorithm_x.h"
+#include "work_queue.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace algorithm_x {
+
+/* search_in_parallel() runs an exhaustive search on thread_count threads and
+ * returns the number of solutions. The solutions themselves are appended to
+ * solutions only if store_solutions is set.
+ */
+template <typename Index>
+uint64_t
+BasicExactCoverProblem<Index>::search_in_parallel(int64_t thread_count,
+                                                  bool store_solutions) {
+  // The links must be copied as they are before any search.
+  start_search();
+  search_state = SearchState::finished;
+  WorkQueue queue{thread_count};
+  queue.give({});
+
+  /* Each worker gets its own copy of the problem, and with it its own copy of
+   * the links, taken while they are still in their initial state.
+   */
+  std::vector<BasicExactCoverProblem> workers;
+  workers.reserve(thread_count);
+  for (int64_t k = 0; k < thread_count; ++k) {
+    workers.emplace_back(*this);
+  }
+  std::vector<std::vector<std::vector<Index>>> solution_paths(thread_count);
+  std::vector<uint64_t> counts(thread_count);
+  std::vector<std::thread> threads;
+  for (int64_t k = 0; k < thread_count; ++k) {
+    threads.emplace_back([&workers, &queue, &solution_paths, &counts,
+                          store_solutions, k]() {
+      counts[k] =
+          workers[k].solve_jobs(queue, store_solutions, solution_paths[k]);
+    });
+  }
+  uint64_t count = 0;
+  for (int64_t k = 0; k < thread_count; ++k) {
+    threads[k].join();
+    count += counts[k];
+    search_nodes += workers[k].search_nodes;
+    ALGORITHM_X_COUNT(stats.add(workers[k].stats));
+  }
+  status = queue.status;
+  if (!store_solutions) {
+    return count;
+  }
+  ALGORITHM_X_TIME(stats.merge_seconds);
+
+  /* Each item's options are tried in the order of their nodes, so sorting the
+   * solutions by the node indices of their candidate stacks puts them in the
+   * order in which a single thread would have found them.
+   */
+  std::vector<std::pair<int64_t, int64_t>> order;
+  for (int64_t k = 0; k < thread_count; ++k) {
+    for (int64_t m = 0; m < (int64_t)solution_paths[k].size(); ++m) {
+      order.push_back({k, m});
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [&solution_paths](const std::pair<int64_t, int64_t> &a,
+                              const std::pair<int64_t, int64_t> &b) {
+              return solution_paths[a.first][a.second] <
+                     solution_paths[b.first][b.second];
+            });
+  for (const std::pair<int64_t, int64_t> &found : order) {
+    solutions.append(workers[found.first].solutions, found.second);
+  }
+  return count;
+}
+
+template <typename Index>
+uint64_t BasicExactCoverProblem<Index>::solve_jobs(
+    WorkQueue &queue, bool store_solutions,
+    std::vector<std::vector<Index>> &solution_paths) {
+  work_queue = &queue;
+  search_nodes = 0;
+  solutions_found = 0;
+  shared_nodes = 0;
+  shared_solutions = 0;
+  ALGORITHM_X_COUNT(stats.clear());
+  // A copy of the problem does not keep the capacity reserved for candidate.
+  candidate.reserve(option_count());
+  uint64_t count = 0;
+  std::vector<Index> job;
+  while (queue.take(job)) {
+    replay(job);
+    while (resume_search()) {
+      ++count;
+      if (store_solutions) {
+        append_solution();
+        solution_paths.push_back(candidate);
+        /* Under Algorithm M, a level that chose no option for its item i holds
+         * i itself, a branch taken after all of i's options.
+         */
+        for (Index &x : solution_paths.back()) {
+          if (x <= primary_count) {
+            x = std::numeric_limits<Index>::max();
+          }
+        }
+      }
+    }
+    unwind();
+  }
+  work_queue = nullptr;
+  return count;
+}
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::share_work(Index l) {
+  if (!work_queue->wants_work()) {
+    return;
+  }
+  /* Give away the untried options at the shallowest level that has any, since
+   * they head the largest of the subtrees left to this thread.
+   */
+  for (Index d = root_level; d < l; ++d) {
+    if (candidate[d] <= primary_count) {
+      // Passing over an item is the last branch at a level of Algorithm M.
+      continue;
+    }
+    Index next = nodes[candidate[d]].dlink;
+    /* Algorithm M has one more branch after the options, passing over the
+     * item, which is given away as the item itself.
+     */
+    if (next != nodes[candidate[d]].top || !bound.empty()) {
+      std::vector<Index> job(candidate.begin(), candidate.begin() + d);
+      job.push_back(next);
+      work_queue->give(std::move(job));
+      /* The options after x_d now belong to another thread, so this one must
+       * not backtrack into level d.
+       */
+      root_level = d + 1;
+      return;
+    }
+  }
+}
+
+template uint64_t
+BasicExactCoverProblem<int32_t>::search_in_parallel(int64_t, bool);
+template uint64_t
+BasicExactCoverProblem<int64_t>::search_in_parallel(int64_t, bool);
+template void BasicExactCoverProblem<int32_t>::share_work(int32_t);
+template void BasicExactCoverProblem<int64_t>::share_work(int64_t);
+
+} // namespace algorithm_x
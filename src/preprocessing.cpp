@@ -0,0 +1,294 @@
+#include "algorithm_x.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace algorithm_x {
+
+template <typename Index>
+PreprocessingReport
+BasicExactCoverProblem<Index>::preprocess(bool keep_all_solutions) {
+  if (!bound.empty()) {
+    throw std::logic_error("Preprocessing does not handle multiplicities.");
+  }
+  // The links are changed as they are before any search.
+  start_search();
+  search_state = SearchState::finished;
+  solved = false;
+  solutions.clear();
+  preprocessed = true;
+
+  PreprocessingReport report;
+  for (Index i = items[0].rlink; i != 0; i = items[i].rlink) {
+    ++report.items_before;
+  }
+  std::vector<Index> options = options_in_play();
+  report.options_before = options.size();
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    ++report.rounds;
+    /* An item with a single option forces it, exactly as the search would
+     * choose it at every node of the tree. The item the search would choose
+     * is one of the shortest, so there is nothing more to force once it has
+     * two options.
+     */
+    while (items[0].rlink != 0) {
+      Index i = choose_item_to_cover();
+      if (len(i) == 0) {
+        report.infeasible = true;
+        break;
+      }
+      if (len(i) > 1) {
+        break;
+      }
+      Index x = nodes[i].dlink;
+      cover(i);
+      cover_other_items(x);
+      forced.push_back(x);
+      ++report.forced_options;
+      changed = true;
+    }
+    if (report.infeasible) {
+      break;
+    }
+    options = options_in_play();
+    if (!keep_all_solutions) {
+      int64_t dominated = remove_dominated_options(options);
+      if (dominated > 0) {
+        report.dominated_options += dominated;
+        changed = true;
+        options = options_in_play();
+      }
+    }
+    for (Index x : options) {
+      if (is_blocked(x)) {
+        remove_option(x);
+        ++report.blocked_options;
+        changed = true;
+      }
+    }
+  }
+
+  for (Index i = items[0].rlink; i != 0; i = items[i].rlink) {
+    ++report.items_after;
+  }
+  report.options_after = options_in_play().size();
+  report.clashing_options =
+      report.options_before - report.options_after - report.forced_options -
+      report.blocked_options - report.dominated_options;
+  return report;
+}
+
+/* options_in_play() returns a node of a primary item for each option that the
+ * search could still choose, that is, each option still in the list of an
+ * active primary item.
+ */
+template <typename Index>
+std::vector<Index> BasicExactCoverProblem<Index>::options_in_play() {
+  std::vector<Index> options;
+  std::vector<bool> is_listed(option_count());
+  for (Index i = items[0].rlink; i != 0; i = items[i].rlink) {
+    for (Index x = nodes[i].dlink; x != i; x = nodes[x].dlink) {
+      int64_t k = option_of(x);
+      if (!is_listed[k]) {
+        is_listed[k] = true;
+        options.push_back(x);
+      }
+    }
+  }
+  return options;
+}
+
+/* is_blocked() tells whether choosing the option of node x would leave some
+ * primary item with no options, which is one step of lookahead beyond what
+ * the search sees before it chooses.
+ */
+template <typename Index>
+bool BasicExactCoverProblem<Index>::is_blocked(Index x) {
+  Index i = nodes[x].top;
+  cover(i);
+  cover_other_items(x);
+  bool blocked = items[0].rlink != 0 && len(choose_item_to_cover()) == 0;
+  uncover_other_items(x);
+  uncover(i);
+  return blocked;
+}
+
+/* remove_option() takes every node of the option of node x out of its list
+ * for good. Unlike hide(), it also takes out x, and the nodes of items
+ * purified with their color, since nothing will put them back.
+ */
+template <typename Index>
+void BasicExactCoverProblem<Index>::remove_option(Index x) {
+  Index q = x;
+  do {
+    Index j = nodes[q].top;
+    if (j <= 0) {
+      // q is the spacer after the option; go round to its first node.
+      q = nodes[q].ulink;
+      continue;
+    }
+    Index u = nodes[q].ulink;
+    Index d = nodes[q].dlink;
+    nodes[u].dlink = d;
+    nodes[d].ulink = u;
+    --len(j);
+    if (j <= last_bucketed_item) {
+      length_buckets.shorten(j, len(j));
+    }
+    ++q;
+  } while (q != x);
+}
+
+template <typename Index>
+bool BasicExactCoverProblem<Index>::break_symmetry(
+    const std::vector<int64_t> &image) {
+  if (!bound.empty()) {
+    throw std::logic_error("Symmetries cannot be broken under "
+                           "multiplicities.");
+  }
+  if (preprocessed) {
+    throw std::logic_error("A symmetry must be broken before preprocessing, "
+                           "and only once.");
+  }
+  int64_t m = option_count();
+  if ((int64_t)image.size() != m) {
+    throw std::invalid_argument("A symmetry must map every option.");
+  }
+  for (int64_t k = 0; k < m; ++k) {
+    if (image[k] < 0 || image[k] >= m || image[image[k]] != k) {
+      throw std::invalid_argument("A symmetry must be an involution of the "
+                                  "options.");
+    }
+  }
+  start_search();
+  search_state = SearchState::finished;
+
+  /* The options of item i are swapped in pairs if none is its own image and
+   * the image of each is again an option of i, found by marking them with i.
+   */
+  std::vector<Index> marks(m);
+  Index best = 0;
+  for (Index i = items[0].rlink; i != 0; i = items[i].rlink) {
+    if (len(i) == 0 || (best != 0 && len(i) >= len(best))) {
+      continue;
+    }
+    bool is_paired = true;
+    for (Index x = nodes[i].dlink; x != i; x = nodes[x].dlink) {
+      int64_t k = option_of(x);
+      marks[k] = i;
+      is_paired = is_paired && image[k] != k;
+    }
+    for (Index x = nodes[i].dlink; x != i && is_paired; x = nodes[x].dlink) {
+      is_paired = marks[image[option_of(x)]] == i;
+    }
+    if (is_paired) {
+      best = i;
+    }
+  }
+  if (best == 0) {
+    return false;
+  }
+  std::vector<Index> removed;
+  for (Index x = nodes[best].dlink; x != best; x = nodes[x].dlink) {
+    int64_t k = option_of(x);
+    if (image[k] < k) {
+      removed.push_back(x);
+    }
+  }
+  for (Index x : removed) {
+    remove_option(x);
+  }
+  solved = false;
+  solutions.clear();
+  preprocessed = true;
+  return true;
+}
+
+/* remove_dominated_options() removes each of the given options for which
+ * another has the same primary items and a subset of its claims on secondary
+ * items, a claim being an item with its color, or with 0 for none. A
+ * solution with the removed option is still a solution with the other one in
+ * its place. Of two options with the same claims, the later is removed. The
+ * nodes of items already purified make no claims, since every option left in
+ * the lists agrees with them. It returns the number of options removed.
+ */
+template <typename Index>
+int64_t BasicExactCoverProblem<Index>::remove_dominated_options(
+    const std::vector<Index> &options) {
+  int64_t m = options.size();
+  std::vector<int64_t> indices(m);
+  std::vector<std::vector<std::pair<Index, Index>>> claims(m);
+  std::vector<int64_t> primary_sizes(m);
+  for (int64_t k = 0; k < m; ++k) {
+    indices[k] = option_of(options[k]);
+    Index x = options[k];
+    Index q = x;
+    do {
+      Index j = nodes[q].top;
+      if (j <= 0) {
+        q = nodes[q].ulink;
+        continue;
+      }
+      Index c = j <= last_plain_item ? 0 : node_colors[q];
+      if (c >= 0) {
+        claims[k].emplace_back(j, c);
+      }
+      primary_sizes[k] += j <= primary_count;
+      ++q;
+    } while (q != x);
+    // Primary items come first, so the claims begin with them.
+    std::sort(claims[k].begin(), claims[k].end());
+  }
+
+  // Options with the same primary items are brought together, in order.
+  auto primaries_before = [&claims, &primary_sizes](int64_t a, int64_t b) {
+    return std::lexicographical_compare(
+        claims[a].begin(), claims[a].begin() + primary_sizes[a],
+        claims[b].begin(), claims[b].begin() + primary_sizes[b]);
+  };
+  std::vector<int64_t> order(m);
+  for (int64_t k = 0; k < m; ++k) {
+    order[k] = k;
+  }
+  std::sort(order.begin(), order.end(), [&indices](int64_t a, int64_t b) {
+    return indices[a] < indices[b];
+  });
+  std::stable_sort(order.begin(), order.end(), primaries_before);
+
+  std::vector<Index> dominated;
+  for (int64_t start = 0, end; start < m; start = end) {
+    end = start + 1;
+    while (end < m && !primaries_before(order[start], order[end])) {
+      ++end;
+    }
+    for (int64_t s = start; s < end; ++s) {
+      const std::vector<std::pair<Index, Index>> &a = claims[order[s]];
+      for (int64_t t = start; t < end; ++t) {
+        const std::vector<std::pair<Index, Index>> &b = claims[order[t]];
+        // Within the group, the options are in the order of their indices.
+        if (t != s && (b.size() < a.size() || t < s) &&
+            std::includes(a.begin(), a.end(), b.begin(), b.end())) {
+          dominated.push_back(options[order[s]]);
+          break;
+        }
+      }
+    }
+  }
+  for (Index x : dominated) {
+    remove_option(x);
+  }
+  return dominated.size();
+}
+
+template PreprocessingReport BasicExactCoverProblem<int32_t>::preprocess(bool);
+template PreprocessingReport BasicExactCoverProblem<int64_t>::preprocess(bool);
+template bool
+BasicExactCoverProblem<int32_t>::break_symmetry(const std::vector<int64_t> &);
+template bool
+BasicExactCoverProblem<int64_t>::break_symmetry(const std::vector<int64_t> &);
+
+} // namespace algorithm_x
@@ -0,0 +1,46 @@
+#ifndef PREPROCESSING_H
+#define PREPROCESSING_H
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace algorithm_x {
+
+/* A PreprocessingReport tells how far preprocess() shrank a problem. Items
+ * are the primary items still to be covered, and options those that the
+ * search could still choose, so that options_before - options_after is made
+ * up of the forced options, the blocked and dominated options that were
+ * removed, and the clashing options, which were hidden by forcing others.
+ */
+struct PreprocessingReport {
+  int64_t rounds = 0;
+  int64_t items_before = 0;
+  int64_t items_after = 0;
+  int64_t options_before = 0;
+  int64_t options_after = 0;
+  int64_t forced_options = 0;
+  int64_t clashing_options = 0;
+  int64_t blocked_options = 0;
+  int64_t dominated_options = 0;
+  // infeasible is set once some item is found to have no options left.
+  bool infeasible = false;
+
+  const std::string to_string() const {
+    std::stringstream ss;
+    ss << "items " << items_before << " -> " << items_after << ", options "
+       << options_before << " -> " << options_after << " in " << rounds
+       << " round(s): " << forced_options << " forced, " << clashing_options
+       << " clashing, " << blocked_options << " blocked, " << dominated_options
+       << " dominated";
+    if (infeasible) {
+      ss << "; no solution";
+    }
+    ss << '\n';
+    return ss.str();
+  }
+};
+
+} // namespace algorithm_x
+
+#endif // #define PREPROCESSING_H
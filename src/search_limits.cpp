@@ -0,0 +1,190 @@
+#include "algorithm_x.h"
+#include "work_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace algorithm_x {
+
+namespace {
+
+/* The clock and the cancel token are looked at every check_interval nodes,
+ * which keeps their cost out of sight while a search stops within a
+ * millisecond or so of being told to.
+ */
+const uint64_t check_interval = 1024;
+
+} // namespace
+
+template <typename Index>
+void BasicExactCoverProblem<Index>::set_search_limits(
+    SearchLimits search_limits) {
+  if (search_limits.seconds < 0 || search_limits.progress_seconds < 0 ||
+      search_limits.checkpoint_seconds < 0) {
+    throw std::invalid_argument("Times cannot be negative.");
+  }
+  limits = std::move(search_limits);
+}
+
+// start_limits() readies the limits for a search about to start.
+template <typename Index> void BasicExactCoverProblem<Index>::start_limits() {
+  status = SearchStatus::complete;
+  solutions_found = 0;
+  shared_nodes = 0;
+  shared_solutions = 0;
+  search_start = std::chrono::steady_clock::now();
+  last_report = search_start;
+  last_report_nodes = 0;
+  last_checkpoint = search_start;
+  bool is_limited = limits.seconds > 0 || limits.nodes > 0 ||
+                    limits.solutions > 0 || limits.cancel_token != nullptr ||
+                    limits.progress || !limits.checkpoint_path.empty();
+  next_check = is_limited ? 0 : std::numeric_limits<uint64_t>::max();
+}
+
+/* within_limits() is called on entering level l once search_nodes reaches
+ * next_check. It returns false if the search must stop, and otherwise
+ * reports progress and writes a checkpoint if it is time to, and sets the
+ * next check.
+ */
+template <typename Index>
+bool BasicExactCoverProblem<Index>::within_limits(Index l) {
+  next_check = search_nodes + check_interval;
+  uint64_t nodes = search_nodes;
+  uint64_t found = solutions_found;
+  if (work_queue == nullptr) {
+    if (limits.nodes > 0) {
+      next_check = std::min(next_check, limits.nodes);
+    }
+  } else {
+    // A worker adds its own counts to the totals of the whole search.
+    if (work_queue->stopped.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    nodes = work_queue->nodes.fetch_add(search_nodes - shared_nodes) +
+            (search_nodes - shared_nodes);
+    found = work_queue->solutions.fetch_add(solutions_found -
+                                            shared_solutions) +
+            (solutions_found - shared_solutions);
+    shared_nodes = search_nodes;
+    shared_solutions = solutions_found;
+  }
+
+  if (limits.cancel_token != nullptr && limits.cancel_token->is_cancelled()) {
+    return stop_search(SearchStatus::cancelled);
+  }
+  if (limits.nodes > 0 && nodes >= limits.nodes) {
+    return stop_search(SearchStatus::out_of_nodes);
+  }
+  if (limits.solutions > 0 && found >= limits.solutions) {
+    return stop_search(SearchStatus::out_of_solutions);
+  }
+  bool is_checkpointed =
+      !limits.checkpoint_path.empty() && work_queue == nullptr;
+  if (limits.seconds <= 0 && !limits.progress && !is_checkpointed) {
+    return true;
+  }
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(now - search_start).count();
+  if (limits.seconds > 0 && seconds >= limits.seconds) {
+    return stop_search(SearchStatus::out_of_time);
+  }
+  if (is_checkpointed &&
+      std::chrono::duration<double>(now - last_checkpoint).count() >=
+          limits.checkpoint_seconds) {
+    // Level l is about to be entered, with x_0, ..., x_{l-1} chosen.
+    level = l;
+    search_state = SearchState::enter_level;
+    checkpoint(limits.checkpoint_path);
+    last_checkpoint = now;
+  }
+  if (!limits.progress) {
+    return true;
+  }
+
+  /* The workers of a parallel search share the time of the last report, and
+   * one that finds another reporting does not wait to report too.
+   */
+  std::unique_lock<std::mutex> lock;
+  std::chrono::steady_clock::time_point *reported = &last_report;
+  uint64_t *reported_nodes = &last_report_nodes;
+  if (work_queue != nullptr) {
+    lock = std::unique_lock<std::mutex>(work_queue->mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return true;
+    }
+    reported = &work_queue->last_report;
+    reported_nodes = &work_queue->last_report_nodes;
+  }
+  double interval = std::chrono::duration<double>(now - *reported).count();
+  if (interval < limits.progress_seconds) {
+    return true;
+  }
+  SearchProgress progress;
+  progress.nodes = nodes;
+  progress.solutions = found;
+  progress.seconds = seconds;
+  progress.nodes_per_second =
+      interval > 0 ? (nodes - std::min(nodes, *reported_nodes)) / interval : 0;
+  progress.fraction_done = work_queue == nullptr
+                               ? fraction_done(l)
+                               : std::numeric_limits<double>::quiet_NaN();
+  *reported = now;
+  *reported_nodes = nodes;
+  limits.progress(progress);
+  return true;
+}
+
+/* stop_search() records why the search stopped, and stops the other workers
+ * of a parallel search too. It returns false, for within_limits().
+ */
+template <typename Index>
+bool BasicExactCoverProblem<Index>::stop_search(SearchStatus reason) {
+  status = reason;
+  if (work_queue != nullptr) {
+    work_queue->stop(reason);
+  }
+  return false;
+}
+
+/* fraction_done() estimates the fraction of the tree below root_level that
+ * the search has passed on entering level l; see SearchProgress. The option
+ * x_m tried at level m is found among those of its item i by walking down
+ * from the head of the list. Nothing below level m can change that list,
+ * since all of the options of i were hidden from every other item when i was
+ * covered, so LEN(i) is still the number of options tried there.
+ */
+template <typename Index>
+double BasicExactCoverProblem<Index>::fraction_done(Index l) {
+  if (!bound.empty()) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  double fraction = 0;
+  double scale = 1;
+  for (Index m = root_level; m < l; ++m) {
+    Index x = candidate[m];
+    Index i = nodes[x].top;
+    Index k = 0;
+    for (Index y = nodes[i].dlink; y != x; y = nodes[y].dlink) {
+      ++k;
+    }
+    scale /= len(i);
+    fraction += k * scale;
+  }
+  return fraction;
+}
+
+template void
+BasicExactCoverProblem<int32_t>::set_search_limits(SearchLimits);
+template void
+BasicExactCoverProblem<int64_t>::set_search_limits(SearchLimits);
+template void BasicExactCoverProblem<int32_t>::start_limits();
+template void BasicExactCoverProblem<int64_t>::start_limits();
+template bool BasicExactCoverProblem<int32_t>::within_limits(int32_t);
+template bool BasicExactCoverProblem<int64_t>::within_limits(int64_t);
+
+} // namespace algorithm_x
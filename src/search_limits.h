@@ -0,0 +1,81 @@
+#ifndef SEARCH_LIMITS_H
+#define SEARCH_LIMITS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace algorithm_x {
+
+/* A CancelToken lets any thread stop the searches that were given it in their
+ * SearchLimits. Cancelling is only a store, and the search notices it within
+ * a few thousand nodes.
+ */
+class CancelToken {
+public:
+  void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+  void reset() { cancelled.store(false, std::memory_order_relaxed); }
+  bool is_cancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<bool> cancelled{false};
+};
+
+/* SearchProgress is passed to the progress callback of a search. The fraction
+ * of the tree done is Knuth's estimate from the positions of the options
+ * being tried: if the option at level l is the k_l-th of the d_l options of
+ * its item, the search is past the fraction
+ *   (k_1 - 1) / d_1 + (k_2 - 1) / (d_1 d_2) + ...
+ * of the tree, counting each subtree as if it were as large as its siblings.
+ * It is NaN where the positions do not tell, in a parallel search or under
+ * multiplicities. The rate is that since the last report.
+ */
+struct SearchProgress {
+  uint64_t nodes = 0;
+  uint64_t solutions = 0;
+  double seconds = 0;
+  double nodes_per_second = 0;
+  double fraction_done = 0;
+};
+
+/* SearchLimits bounds the searches started after it is given to a problem.
+ * A limit of 0 means there is none. A search that reaches one stops, as if
+ * its tree had been exhausted, with the solutions found so far. The limits on
+ * nodes and solutions are exact in a search on one thread, and may be
+ * overshot by a few thousand nodes in a parallel one.
+ *
+ * If progress is set, it is called every progress_seconds or so from the
+ * thread running the search, or from one of the threads of a parallel
+ * search, which waits meanwhile, so it should be quick.
+ *
+ * If checkpoint_path is set, a search on one thread saves its position there
+ * every checkpoint_seconds, as checkpoint() would, so that a run cut short can
+ * be taken up again by resume(). Each checkpoint is written beside the file
+ * and then renamed over it, so the last one survives a crash while writing.
+ */
+struct SearchLimits {
+  double seconds = 0;
+  uint64_t nodes = 0;
+  uint64_t solutions = 0;
+  const CancelToken *cancel_token = nullptr;
+  std::function<void(const SearchProgress &)> progress;
+  double progress_seconds = 1;
+  std::string checkpoint_path;
+  double checkpoint_seconds = 60;
+};
+
+// SearchStatus tells whether a search ran to the end, or what stopped it.
+enum class SearchStatus {
+  complete,
+  cancelled,
+  out_of_time,
+  out_of_nodes,
+  out_of_solutions
+};
+
+} // namespace algorithm_x
+
+#endif // #define SEARCH_LIMITS_H
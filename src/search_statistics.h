@@ -0,0 +1,125 @@
+#ifndef SEARCH_STATISTICS_H
+#define SEARCH_STATISTICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* The statistics are gathered only if ALGORITHM_X_STATS is defined, as it is
+ * by `make stats`. Otherwise ALGORITHM_X_COUNT() and ALGORITHM_X_TIME() expand
+ * to nothing, and the search does no more work than it would without them.
+ */
+#ifdef ALGORITHM_X_STATS
+#define ALGORITHM_X_COUNT(expression) (expression)
+#define ALGORITHM_X_TIME(seconds)                                              \
+  algorithm_x::PhaseTimer phase_timer { seconds }
+#else
+#define ALGORITHM_X_COUNT(expression) ((void)0)
+#define ALGORITHM_X_TIME(seconds) ((void)0)
+#endif
+
+namespace algorithm_x {
+
+/* SearchStatistics tells how a search spent its effort, following Knuth's
+ * measures of the dancing links: mems, the number of reads and writes of the
+ * links (a read and then a write of the same field counting as one), and
+ * updates, the number of nodes removed from their lists. Nodes are counted for
+ * each level of the search tree, from level 0 at the root.
+ *
+ * The times of the phases nest: search_seconds includes record_seconds, the
+ * time spent storing solutions, and merge_seconds, the time spent putting in
+ * order those found by a parallel search.
+ */
+struct SearchStatistics {
+#ifdef ALGORITHM_X_STATS
+  static constexpr bool enabled = true;
+#else
+  static constexpr bool enabled = false;
+#endif
+
+  uint64_t mems = 0;
+  uint64_t updates = 0;
+  uint64_t solutions = 0;
+  std::vector<uint64_t> level_nodes;
+  double initialize_seconds = 0;
+  double search_seconds = 0;
+  double record_seconds = 0;
+  double merge_seconds = 0;
+
+  void count_node(int64_t level) {
+    if ((int64_t)level_nodes.size() <= level) {
+      level_nodes.resize(level + 1);
+    }
+    ++level_nodes[level];
+  }
+
+  uint64_t nodes() const {
+    uint64_t total = 0;
+    for (uint64_t count : level_nodes) {
+      total += count;
+    }
+    return total;
+  }
+
+  // clear() resets the counts of a search, but not the time to initialize.
+  void clear() {
+    mems = 0;
+    updates = 0;
+    solutions = 0;
+    level_nodes.clear();
+    search_seconds = 0;
+    record_seconds = 0;
+    merge_seconds = 0;
+  }
+
+  // add() adds in the counts of a worker in a parallel search.
+  void add(const SearchStatistics &other) {
+    mems += other.mems;
+    updates += other.updates;
+    solutions += other.solutions;
+    if (level_nodes.size() < other.level_nodes.size()) {
+      level_nodes.resize(other.level_nodes.size());
+    }
+    for (int64_t l = 0; l < (int64_t)other.level_nodes.size(); ++l) {
+      level_nodes[l] += other.level_nodes[l];
+    }
+    record_seconds += other.record_seconds;
+  }
+
+  const std::string to_string() const {
+    std::stringstream ss;
+    ss << "mems: " << mems << "\nupdates: " << updates
+       << "\nsolutions: " << solutions << "\nnodes: " << nodes()
+       << "\nnodes by level:";
+    for (uint64_t count : level_nodes) {
+      ss << ' ' << count;
+    }
+    ss << "\ninitialize (s): " << initialize_seconds
+       << "\nsearch (s): " << search_seconds
+       << "\n  record (s): " << record_seconds
+       << "\n  merge (s): " << merge_seconds << '\n';
+    return ss.str();
+  }
+};
+
+// A PhaseTimer adds the time from its construction to its destruction.
+class PhaseTimer {
+public:
+  explicit PhaseTimer(double &seconds)
+      : seconds(seconds), start(std::chrono::steady_clock::now()) {}
+  ~PhaseTimer() {
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+                   .count();
+  }
+
+private:
+  double &seconds;
+  std::chrono::steady_clock::time_point start;
+};
+
+} // namespace algorithm_x
+
+#endif // #define SEARCH_STATISTICS_H
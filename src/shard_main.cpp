@@ -0,0 +1,70 @@
+#include "algorithm_x.h"
+#include "job_shards.h"
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * This entry point splits the search of a problem written in Knuth's DLX
+ * format into jobs that separate processes, on one machine or many, can run
+ * without sharing anything, and merges their results.
+ *
+ * Usage: shard split PROBLEM DEPTH JOBS
+ *        shard work PROBLEM JOBS K RESULT [--count]
+ *        shard merge JOBS [--solutions FILE] RESULT...
+ *
+ * split lists a job in JOBS for each node at level DEPTH of the search tree.
+ * work runs job K and writes its solutions and counts to RESULT, or only its
+ * counts with --count. merge checks that every job has one result, prints
+ * the totals, and with --solutions writes every solution to FILE, one to a
+ * line as the indices of its options, in the order of a search on one
+ * thread.
+ */
+int main(int argc, char *argv[]) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+  std::string mode = args.empty() ? "" : args[0];
+  try {
+    if (mode == "split" && args.size() == 4) {
+      algorithm_x::ExactCoverProblem problem =
+          algorithm_x::ExactCoverProblem::read_dlx(args[1]);
+      int64_t jobs = problem.write_jobs(args[3], std::stoll(args[2]));
+      std::cerr << jobs << " job(s) written to " << args[3] << ".\n";
+      return 0;
+    }
+    if (mode == "work" && (args.size() == 5 ||
+                           (args.size() == 6 && args[5] == "--count"))) {
+      algorithm_x::ExactCoverProblem problem =
+          algorithm_x::ExactCoverProblem::read_dlx(args[1]);
+      uint64_t count =
+          problem.run_job(args[2], std::stoll(args[3]), args[4],
+                          args.size() == 5);
+      std::cerr << "Job " << args[3] << ": " << count << " solution(s).\n";
+      return 0;
+    }
+    if (mode == "merge" && args.size() >= 2) {
+      std::string solutions_path;
+      std::vector<std::string> results;
+      for (std::size_t k = 2; k < args.size(); ++k) {
+        if (args[k] == "--solutions" && k + 1 < args.size()) {
+          solutions_path = args[++k];
+        } else {
+          results.push_back(args[k]);
+        }
+      }
+      std::cout << algorithm_x::merge_job_results(args[1], results,
+                                                  solutions_path)
+                       .to_string();
+      return 0;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  std::cerr << "Usage: " << argv[0] << " split PROBLEM DEPTH JOBS\n"
+            << "       " << argv[0] << " work PROBLEM JOBS K RESULT [--count]\n"
+            << "       " << argv[0]
+            << " merge JOBS [--solutions FILE] RESULT...\n";
+  return 2;
+}
@@ -0,0 +1,96 @@
+#include "solution_store.h"
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <unistd.h>
+#include <vector>
+
+namespace algorithm_x {
+
+namespace {
+
+/* A DescriptorWriter gathers bytes into a buffer and hands them to write(2)
+ * a buffer at a time, going on after short writes and interruptions.
+ */
+class DescriptorWriter {
+public:
+  explicit DescriptorWriter(int fd) : fd(fd), used(0) {}
+
+  void put_byte(uint8_t byte) {
+    if (used == sizeof(buffer)) {
+      flush();
+    }
+    buffer[used++] = byte;
+  }
+
+  void put_word(uint64_t word) {
+    for (int b = 0; b < 8; ++b) {
+      put_byte(word >> (8 * b));
+    }
+  }
+
+  void put_varint(uint64_t value) {
+    while (value >= 0x80) {
+      put_byte((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    put_byte(value);
+  }
+
+  void flush() {
+    std::size_t done = 0;
+    while (done < used) {
+      ssize_t written = ::write(fd, buffer + done, used - done);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        throw std::runtime_error("Cannot write the solutions.");
+      }
+      done += written;
+    }
+    used = 0;
+  }
+
+private:
+  int fd;
+  std::size_t used;
+  uint8_t buffer[1 << 16];
+};
+
+} // namespace
+
+void SolutionStore::append(const SolutionStore &other, int64_t k) {
+  option_indices.insert(option_indices.end(), other.options(k),
+                        other.options(k) + other.length(k));
+  lead_positions.insert(lead_positions.end(), other.leads(k),
+                        other.leads(k) + other.length(k));
+  end_solution();
+}
+
+void SolutionStore::clear() {
+  option_indices.clear();
+  lead_positions.clear();
+  offsets.assign(1, 0);
+}
+
+void SolutionStore::write(int fd, SolutionFormat format) const {
+  DescriptorWriter out(fd);
+  for (int64_t k = 0; k < size(); ++k) {
+    const int64_t *option = options(k);
+    if (format == SolutionFormat::binary) {
+      out.put_word(length(k));
+      for (int64_t m = 0; m < length(k); ++m) {
+        out.put_word(option[m]);
+      }
+    } else {
+      out.put_varint(length(k));
+      for (int64_t m = 0; m < length(k); ++m) {
+        out.put_varint(option[m]);
+      }
+    }
+  }
+  out.flush();
+}
+
+} // namespace algorithm_x
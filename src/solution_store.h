@@ -0,0 +1,67 @@
+#ifndef SOLUTION_STORE_H
+#define SOLUTION_STORE_H
+
+#include <cstdint>
+#include <vector>
+
+namespace algorithm_x {
+
+/* SolutionFormat names the encodings of write(). Either way, each solution is
+ * written as the number of its options, then their indices. In binary, every
+ * number takes 8 bytes, little-endian. As varints, every number takes 7 bits
+ * to a byte, lowest first, with the high bit of each byte but the last set, as
+ * in LEB128, so that most indices take a byte or two.
+ */
+enum class SolutionFormat { binary, varint };
+
+/**
+ * A SolutionStore keeps the solutions found by solve() in one flat arena
+ * rather than as a vector of options per solution: the options of solution k
+ * are entries offsets[k], ..., offsets[k + 1] - 1 of a single array of option
+ * indices, which grows as solutions are added. Beside each index it keeps the
+ * position of the lead item, the one through which the option was chosen,
+ * from which get_solutions() can rebuild the items of the option led by it
+ * when asked. So a solution costs about twelve bytes per option and eight
+ * more, and no allocation of its own.
+ */
+class SolutionStore {
+public:
+  int64_t size() const { return offsets.size() - 1; }
+  bool empty() const { return offsets.size() == 1; }
+  // length() is the number of options in solution k.
+  int64_t length(int64_t k) const { return offsets[k + 1] - offsets[k]; }
+  // options() points to the option indices of solution k.
+  const int64_t *options(int64_t k) const {
+    return option_indices.data() + offsets[k];
+  }
+  // leads() points to the positions of the lead items of solution k.
+  const int32_t *leads(int64_t k) const {
+    return lead_positions.data() + offsets[k];
+  }
+
+  // add_option() adds an option to the solution under way.
+  void add_option(int64_t option, int32_t lead) {
+    option_indices.push_back(option);
+    lead_positions.push_back(lead);
+  }
+  // end_solution() ends the solution under way.
+  void end_solution() { offsets.push_back(option_indices.size()); }
+  // append() adds solution k of another store.
+  void append(const SolutionStore &other, int64_t k);
+  void clear();
+
+  /* write() streams the solutions to the file descriptor fd in the given
+   * format, through a buffer of its own, and throws std::runtime_error if
+   * they cannot all be written. The descriptor is left open.
+   */
+  void write(int fd, SolutionFormat format) const;
+
+private:
+  std::vector<int64_t> option_indices;
+  std::vector<int32_t> lead_positions;
+  std::vector<int64_t> offsets{0};
+};
+
+} // namespace algorithm_x
+
+#endif // #define SOLUTION_STORE_H
@@ -0,0 +1,179 @@
+#include "sudoku.h"
+#include "exact_cover_builder.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace algorithm_x {
+
+namespace {
+
+/* sudoku_problem() builds the problem of an empty grid, in which option
+ * (r * n + c) * n + d - 1 places digit d in row r and column c.
+ */
+template <typename Index>
+BasicExactCoverProblem<Index> sudoku_problem(int64_t b) {
+  if (b < 1 || b > 5) {
+    throw std::invalid_argument("Boxes must have sides from 1 to 5.");
+  }
+  int64_t n = b * b;
+  BasicExactCoverBuilder<Index> builder(false);
+  builder.reserve(4 * n * n, n * n * n, 4 * n * n * n);
+  for (int64_t i = 1; i <= 4 * n * n; ++i) {
+    builder.add_item(i);
+  }
+  for (int64_t r = 0; r < n; ++r) {
+    for (int64_t c = 0; c < n; ++c) {
+      for (int64_t d = 0; d < n; ++d) {
+        int64_t box = (r / b) * b + c / b;
+        int64_t option[4] = {1 + r * n + c, 1 + n * n + r * n + d,
+                             1 + 2 * n * n + c * n + d,
+                             1 + 3 * n * n + box * n + d};
+        builder.add_option(option, 4);
+      }
+    }
+  }
+  return builder.build();
+}
+
+} // namespace
+
+template <typename Index>
+BasicSudokuSolver<Index>::BasicSudokuSolver(int64_t box_size)
+    : b(box_size), n(box_size * box_size),
+      problem(sudoku_problem<Index>(box_size)) {
+  givens.reserve(n * n);
+  /* Covering the givens hides most of the nodes, so keeping the lengths in
+   * buckets costs more than it saves in choosing among the items left.
+   */
+  problem.use_length_buckets(false);
+}
+
+template <typename Index>
+bool BasicSudokuSolver<Index>::solve(const char *puzzle, char *solution) {
+  givens.clear();
+  for (int64_t k = 0; k < n * n; ++k) {
+    int64_t d = digit(puzzle[k]);
+    if (d < 0 || d > n) {
+      throw std::invalid_argument("A cell must be blank or hold a digit of "
+                                  "the grid.");
+    }
+    if (d > 0) {
+      givens.push_back(k * n + d - 1);
+    }
+  }
+  for (const SolutionView &chosen : problem.enumerate_with(givens)) {
+    for (int64_t option : chosen) {
+      solution[option / n] = symbol(option % n + 1);
+    }
+    return true;
+  }
+  return false;
+}
+
+template <typename Index> int64_t BasicSudokuSolver<Index>::digit(char symbol) {
+  if (symbol == '.' || symbol == '0') {
+    return 0;
+  }
+  if (symbol >= '1' && symbol <= '9') {
+    return symbol - '0';
+  }
+  if (symbol >= 'A' && symbol <= 'Z') {
+    return symbol - 'A' + 10;
+  }
+  if (symbol >= 'a' && symbol <= 'z') {
+    return symbol - 'a' + 10;
+  }
+  return -1;
+}
+
+template <typename Index> char BasicSudokuSolver<Index>::symbol(int64_t digit) {
+  return digit <= 9 ? '0' + digit : 'A' + digit - 10;
+}
+
+template class BasicSudokuSolver<int32_t>;
+template class BasicSudokuSolver<int64_t>;
+
+uint64_t solve_sudokus(std::istream &in, std::ostream &out, int64_t box_size,
+                       int64_t thread_count) {
+  if (thread_count < 1) {
+    throw std::invalid_argument("At least one thread is needed to solve.");
+  }
+  std::vector<SudokuSolver> solvers;
+  solvers.reserve(thread_count);
+  for (int64_t t = 0; t < thread_count; ++t) {
+    solvers.emplace_back(box_size);
+  }
+  int64_t n = solvers[0].side();
+  int64_t cells = n * n;
+  /* The puzzles are read a block at a time, each thread solving a run of the
+   * block, and the solutions are written out in order before the next block
+   * is read.
+   */
+  const int64_t block_size = 4096 * thread_count;
+  std::vector<char> puzzles;
+  std::vector<char> lines;
+  std::vector<uint64_t> counts(thread_count);
+  std::string line;
+  int64_t line_number = 0;
+  uint64_t solved = 0;
+  bool more = true;
+  while (more) {
+    puzzles.clear();
+    int64_t count = 0;
+    while (count < block_size && (more = (bool)std::getline(in, line))) {
+      ++line_number;
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      if (line.empty()) {
+        continue;
+      }
+      bool is_puzzle = (int64_t)line.size() == cells;
+      for (char symbol : line) {
+        int64_t d = SudokuSolver::digit(symbol);
+        is_puzzle = is_puzzle && d >= 0 && d <= n;
+      }
+      if (!is_puzzle) {
+        throw std::invalid_argument("Line " + std::to_string(line_number) +
+                                    " is not a puzzle.");
+      }
+      puzzles.insert(puzzles.end(), line.begin(), line.end());
+      ++count;
+    }
+    lines.resize(count * (cells + 1));
+    auto solve_run = [&](int64_t t) {
+      counts[t] = 0;
+      for (int64_t k = t * count / thread_count;
+           k < (t + 1) * count / thread_count; ++k) {
+        const char *puzzle = &puzzles[k * cells];
+        char *solution = &lines[k * (cells + 1)];
+        if (solvers[t].solve(puzzle, solution)) {
+          ++counts[t];
+        } else {
+          std::copy(puzzle, puzzle + cells, solution);
+        }
+        solution[cells] = '\n';
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int64_t t = 1; t < thread_count; ++t) {
+      threads.emplace_back(solve_run, t);
+    }
+    solve_run(0);
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+    for (uint64_t c : counts) {
+      solved += c;
+    }
+    out.write(lines.data(), lines.size());
+  }
+  return solved;
+}
+
+} // namespace algorithm_x
@@ -0,0 +1,60 @@
+#ifndef SUDOKU_H
+#define SUDOKU_H
+
+#include "algorithm_x.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace algorithm_x {
+
+/* A BasicSudokuSolver solves sudoku puzzles whose boxes have side b, and
+ * whose grids have side n = b * b, one after another on the same exact cover
+ * problem, built once. Its items are the cells, and the pairings of each digit
+ * with each row, column and box, as in Knuth (p. 73); its options place each
+ * digit in each cell. The givens of a puzzle are assumed, as by solve_with(),
+ * rather than built into a problem of its own.
+ *
+ * A puzzle is written as its n * n cells, row by row, each a digit from 1 to
+ * 9 and then a letter from A for 10 on, or '.' or '0' if it is blank.
+ */
+template <typename Index> class BasicSudokuSolver {
+public:
+  explicit BasicSudokuSolver(int64_t box_size = 3);
+
+  int64_t side() const { return n; }
+  /* solve() reads a puzzle from the n * n characters at puzzle, and writes its
+   * first solution to the n * n characters at solution, returning false, and
+   * writing nothing, if it has none.
+   */
+  bool solve(const char *puzzle, char *solution);
+  // search_node_count() is that of the last puzzle solved.
+  uint64_t search_node_count() const { return problem.search_node_count(); }
+
+  // digit() and symbol() convert between cells and the values 1, ..., n.
+  static int64_t digit(char symbol);
+  static char symbol(int64_t digit);
+
+private:
+  int64_t b;
+  int64_t n;
+  BasicExactCoverProblem<Index> problem;
+  // The options of the givens of the puzzle being solved.
+  std::vector<int64_t> givens;
+};
+
+using SudokuSolver = BasicSudokuSolver<int32_t>;
+
+/* solve_sudokus() reads puzzles from in, one to a line, and writes each
+ * solution to out as a line of n * n characters, in the order of the puzzles.
+ * A puzzle with no solution is written back as it was given. Blank lines are
+ * skipped. The puzzles are shared among thread_count threads, each with a
+ * solver of its own. It returns the number of puzzles solved, and throws
+ * std::invalid_argument at a line that is not a puzzle.
+ */
+uint64_t solve_sudokus(std::istream &in, std::ostream &out,
+                       int64_t box_size = 3, int64_t thread_count = 1);
+
+} // namespace algorithm_x
+
+#endif // #define SUDOKU_H
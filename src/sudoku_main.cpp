@@ -0,0 +1,52 @@
+#include "sudoku.h"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/*
+ * This entry point solves a file of sudoku puzzles, one to a line, writing
+ * their solutions to standard output in the same order.
+ *
+ * Usage: sudoku [--box B] [--threads T] [FILE]
+ *
+ * The boxes have side B, 3 by default; FILE defaults to standard input.
+ */
+int main(int argc, char *argv[]) {
+  int64_t box_size = 3;
+  int64_t thread_count = 1;
+  std::string path;
+  for (int k = 1; k < argc; ++k) {
+    std::string arg = argv[k];
+    if (arg == "--box" && k + 1 < argc) {
+      box_size = std::stoll(argv[++k]);
+    } else if (arg == "--threads" && k + 1 < argc) {
+      thread_count = std::stoll(argv[++k]);
+    } else if (path.empty() && arg[0] != '-') {
+      path = arg;
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--box B] [--threads T] [FILE]\n";
+      return 2;
+    }
+  }
+  std::ifstream file;
+  if (!path.empty()) {
+    file.open(path);
+    if (!file) {
+      std::cerr << "Cannot open " << path << ".\n";
+      return 1;
+    }
+  }
+  std::ios::sync_with_stdio(false);
+  try {
+    uint64_t solved = algorithm_x::solve_sudokus(
+        path.empty() ? std::cin : file, std::cout, box_size, thread_count);
+    std::cerr << solved << " puzzle(s) solved.\n";
+  } catch (const std::invalid_argument &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
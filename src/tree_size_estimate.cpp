@@ -0,0 +1,127 @@
+#include "algorithm_x.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+namespace algorithm_x {
+
+template <typename Index>
+TreeSizeEstimate
+BasicExactCoverProblem<Index>::estimate_tree_size(int64_t samples,
+                                                  uint64_t seed) {
+  /*
+   * This is Knuth's estimator of the size of a backtrack tree, from
+   * "Estimating the efficiency of backtrack programs" (Mathematics of
+   * Computation, 1975), and _The Art of Computer Programming_, volume 4,
+   * section 7.2.2. Each probe walks from the root to a leaf as Algorithm X
+   * would, choosing the same item i at each node, but following just one of
+   * its options, picked at random. If the nodes on the way have d_1, d_2, ...
+   * children, the probe estimates that the tree has
+   * 1 + d_1 + d_1 d_2 + ... nodes, and d_1 d_2 ... solutions if it ends at a
+   * solution, or none otherwise; both estimates are unbiased.
+   */
+  if (!bound.empty()) {
+    throw std::logic_error("The tree size can only be estimated without "
+                           "multiplicities.");
+  }
+  if (samples < 1) {
+    throw std::invalid_argument("At least one sample is needed to estimate.");
+  }
+  // Abandon any search under way.
+  start_search();
+  search_state = SearchState::finished;
+  ALGORITHM_X_COUNT(stats.clear());
+
+  /* The time of the search is estimated in the same way, as the sum of the
+   * times spent at its nodes, each probe timing the work of choosing and
+   * covering at the nodes it enters. Undoing that work on the way back is
+   * not timed node by node, but the total time of the probes scales the
+   * estimate up to include it.
+   */
+  using Clock = std::chrono::steady_clock;
+  std::mt19937_64 random(seed);
+  double node_sum = 0;
+  double node_squares = 0;
+  double solution_sum = 0;
+  double solution_squares = 0;
+  double time_sum = 0;
+  double time_squares = 0;
+  double entered_seconds = 0;
+  Clock::time_point start = Clock::now();
+  for (int64_t s = 0; s < samples; ++s) {
+    double weight = 1;
+    double nodes_estimate = 0;
+    double solutions_estimate = 0;
+    double time_estimate = 0;
+    while (true) {
+      Clock::time_point entered = Clock::now();
+      nodes_estimate += weight;
+      bool is_leaf = true;
+      Index d = 0;
+      if (items[0].rlink == 0) {
+        solutions_estimate = weight;
+      } else {
+        Index i = choose_item_to_cover();
+        d = len(i);
+        if (d > 0) {
+          Index x = nodes[i].dlink;
+          for (Index r = std::uniform_int_distribution<Index>(0, d - 1)(random);
+               r > 0; --r) {
+            x = nodes[x].dlink;
+          }
+          cover(i);
+          cover_other_items(x);
+          candidate.push_back(x);
+          is_leaf = false;
+        }
+      }
+      double seconds =
+          std::chrono::duration<double>(Clock::now() - entered).count();
+      entered_seconds += seconds;
+      time_estimate += weight * seconds;
+      if (is_leaf) {
+        break;
+      }
+      weight *= d;
+    }
+    unwind();
+    node_sum += nodes_estimate;
+    node_squares += nodes_estimate * nodes_estimate;
+    solution_sum += solutions_estimate;
+    solution_squares += solutions_estimate * solutions_estimate;
+    time_sum += time_estimate;
+    time_squares += time_estimate * time_estimate;
+  }
+  double probe_seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  // The margins are 1.96 standard errors of the means.
+  auto margin = [samples](double sum, double squares) {
+    if (samples < 2) {
+      return HUGE_VAL;
+    }
+    double mean = sum / samples;
+    double variance = (squares - samples * mean * mean) / (samples - 1);
+    return 1.96 * std::sqrt(std::max(variance, 0.0) / samples);
+  };
+  TreeSizeEstimate estimate;
+  estimate.samples = samples;
+  estimate.nodes = node_sum / samples;
+  estimate.nodes_margin = margin(node_sum, node_squares);
+  estimate.solutions = solution_sum / samples;
+  estimate.solutions_margin = margin(solution_sum, solution_squares);
+  double scale = entered_seconds > 0 ? probe_seconds / entered_seconds : 1;
+  estimate.seconds = time_sum / samples * scale;
+  estimate.seconds_margin = margin(time_sum, time_squares) * scale;
+  return estimate;
+}
+
+template TreeSizeEstimate
+BasicExactCoverProblem<int32_t>::estimate_tree_size(int64_t, uint64_t);
+template TreeSizeEstimate
+BasicExactCoverProblem<int64_t>::estimate_tree_size(int64_t, uint64_t);
+
+} // namespace algorithm_x
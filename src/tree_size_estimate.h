@@ -0,0 +1,43 @@
+#ifndef TREE_SIZE_ESTIMATE_H
+#define TREE_SIZE_ESTIMATE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace algorithm_x {
+
+/* A TreeSizeEstimate is what estimate_tree_size() makes of the search tree
+ * from its random probes: the mean of their estimates of the number of nodes
+ * and of solutions, and of the time an exhaustive search on one thread would
+ * take, each with the margin of a 95% confidence interval around it. The
+ * intervals assume the estimates are roughly normal, which a heavy-tailed
+ * tree may only approach after many samples, so a margin that shrinks slowly
+ * as samples are added is a sign of that.
+ */
+struct TreeSizeEstimate {
+  int64_t samples = 0;
+  double nodes = 0;
+  double nodes_margin = 0;
+  double solutions = 0;
+  double solutions_margin = 0;
+  double seconds = 0;
+  double seconds_margin = 0;
+
+  const std::string to_string() const {
+    std::stringstream ss;
+    ss << "samples: " << samples << "\nnodes: " << nodes << " ["
+       << std::max(0.0, nodes - nodes_margin) << ", " << nodes + nodes_margin
+       << "]\nsolutions: " << solutions << " ["
+       << std::max(0.0, solutions - solutions_margin) << ", "
+       << solutions + solutions_margin << "]\nsearch (s): " << seconds << " ["
+       << std::max(0.0, seconds - seconds_margin) << ", "
+       << seconds + seconds_margin << "]\n";
+    return ss.str();
+  }
+};
+
+} // namespace algorithm_x
+
+#endif // #define TREE_SIZE_ESTIMATE_H
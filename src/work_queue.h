@@ -0,0 +1,110 @@
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include "algorithm_x.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace algorithm_x {
+
+/* A job is the prefix of the candidate stack that leads into a subtree, in the
+ * form taken by replay(): every node but the last is a fixed choice, and the
+ * last is the first of the options still to be tried at the job's root level.
+ * The empty job stands for the whole search tree.
+ *
+ * Jobs are handed out on request. A thread that runs out of work waits in
+ * take(), and busy threads, seeing that someone is waiting, split off the
+ * untried options at their shallowest level as a new job (see share_work()).
+ */
+template <typename Index> struct BasicExactCoverProblem<Index>::WorkQueue {
+  explicit WorkQueue(int64_t worker_count)
+      : worker_count(worker_count), idle_workers(0), queued_jobs(0),
+        finished(false), nodes(0), solutions(0), stopped(false),
+        status(SearchStatus::complete),
+        last_report(std::chrono::steady_clock::now()), last_report_nodes(0) {}
+
+  /* take() blocks until a job is available and returns true, or returns false
+   * once every worker is waiting and no jobs are left, which ends the search.
+   */
+  bool take(std::vector<Index> &job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++idle_workers;
+    while (jobs.empty() && !finished) {
+      if (idle_workers == worker_count) {
+        finished = true;
+        job_available.notify_all();
+      } else {
+        job_available.wait(lock);
+      }
+    }
+    if (jobs.empty()) {
+      return false;
+    }
+    job = std::move(jobs.front());
+    jobs.pop_front();
+    --queued_jobs;
+    --idle_workers;
+    return true;
+  }
+
+  void give(std::vector<Index> job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished) {
+      // The search was stopped, and the job is dropped with the others.
+      return;
+    }
+    jobs.push_back(std::move(job));
+    ++queued_jobs;
+    job_available.notify_one();
+  }
+
+  /* stop() ends a search that has reached one of its limits, for the reason
+   * given by the first worker to stop it. The jobs left are dropped, and
+   * take() returns false from then on.
+   */
+  void stop(SearchStatus reason) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!stopped.load(std::memory_order_relaxed)) {
+      status = reason;
+      stopped.store(true, std::memory_order_relaxed);
+    }
+    finished = true;
+    jobs.clear();
+    queued_jobs = 0;
+    job_available.notify_all();
+  }
+
+  // wants_work() is polled without the lock at every search node.
+  bool wants_work() const {
+    return idle_workers.load(std::memory_order_relaxed) >
+           queued_jobs.load(std::memory_order_relaxed);
+  }
+
+  const int64_t worker_count;
+  std::atomic<int64_t> idle_workers;
+  std::atomic<int64_t> queued_jobs;
+  bool finished;
+  std::mutex mutex;
+  std::condition_variable job_available;
+  std::deque<std::vector<Index>> jobs;
+  /* The nodes entered and solutions found by all of the workers, added in as
+   * each checks its limits, and whether and why the search was stopped.
+   */
+  std::atomic<uint64_t> nodes;
+  std::atomic<uint64_t> solutions;
+  std::atomic<bool> stopped;
+  SearchStatus status;
+  // The last progress report, guarded by the mutex.
+  std::chrono::steady_clock::time_point last_report;
+  uint64_t last_report_nodes;
+};
+
+} // namespace algorithm_x
+
+#endif // #define WORK_QUEUE_H
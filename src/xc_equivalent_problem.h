@@ -2,6 +2,8 @@
 #define XC_EQUIVALENT_H
 
 #include "algorithm_x.h"
+#include <cstdint>
+#include <vector>
 
 namespace algorithm_x {
 
@@ -18,12 +20,33 @@ public:
    * problem. */
   void solve(bool find_all_solutions = true) {}
 
+  /* count_solutions() counts the solutions of the underlying problem, each
+   * solution of exact_cover_problem standing for symmetry_factor of them.
+   */
+  uint64_t count_solutions() {
+    return exact_cover_problem->count_solutions() * symmetry_factor;
+  }
+
   const ExactCoverProblem &get_exact_cover_problem() {
     return *exact_cover_problem;
   }
 
 protected:
+  /* declare_symmetry() hands the engine an involution of the options that
+   * maps solutions to solutions, as for ExactCoverProblem::break_symmetry(),
+   * so that the search finds one solution of each pair. It returns false if
+   * the symmetry could not be used, and the search then finds every solution.
+   */
+  bool declare_symmetry(const std::vector<int64_t> &image) {
+    if (!exact_cover_problem->break_symmetry(image)) {
+      return false;
+    }
+    symmetry_factor *= 2;
+    return true;
+  }
+
   ExactCoverProblem *exact_cover_problem;
+  uint64_t symmetry_factor = 1;
 };
 
 } // namespace algorithm_x
@@ -0,0 +1,83 @@
+#include "zdd.h"
+#include <cstdint>
+#include <vector>
+
+namespace algorithm_x {
+
+Zdd::Zdd() : root_node(bottom) {
+  // The terminals are nodes 0 and 1, and have no options.
+  nodes.push_back({-1, bottom, bottom});
+  nodes.push_back({-1, top, top});
+}
+
+std::size_t Zdd::NodeHash::operator()(const Node &node) const {
+  uint64_t h = node.option;
+  h = h * 0x9e3779b97f4a7c15 + node.lo;
+  h = h * 0x9e3779b97f4a7c15 + node.hi;
+  return h ^ (h >> 29);
+}
+
+bool Zdd::NodeEqual::operator()(const Node &a, const Node &b) const {
+  return a.option == b.option && a.lo == b.lo && a.hi == b.hi;
+}
+
+int64_t Zdd::make_node(int64_t option, int64_t lo, int64_t hi) {
+  if (hi == bottom) {
+    return lo;
+  }
+  Node node{option, lo, hi};
+  auto found = unique_table.find(node);
+  if (found != unique_table.end()) {
+    return found->second;
+  }
+  int64_t k = nodes.size();
+  nodes.push_back(node);
+  unique_table.emplace(node, k);
+  return k;
+}
+
+uint64_t Zdd::count_solutions() const {
+  // Children come before their parents, so one pass upward suffices.
+  std::vector<uint64_t> counts(nodes.size());
+  counts[bottom] = 0;
+  counts[top] = 1;
+  for (int64_t k = 2; k < (int64_t)nodes.size(); ++k) {
+    counts[k] = counts[nodes[k].lo] + counts[nodes[k].hi];
+  }
+  return counts[root_node];
+}
+
+Zdd::SolutionRange Zdd::solutions() const { return SolutionRange(this); }
+
+Zdd::SolutionRange::iterator Zdd::SolutionRange::begin() const {
+  if (zdd->root() == bottom) {
+    return iterator();
+  }
+  iterator first(zdd);
+  first.descend(zdd->root());
+  return first;
+}
+
+void Zdd::SolutionRange::iterator::descend(int64_t k) {
+  while (k != top) {
+    path.push_back(k);
+    options.push_back(zdd->node(k).option);
+    k = zdd->node(k).hi;
+  }
+}
+
+Zdd::SolutionRange::iterator &Zdd::SolutionRange::iterator::operator++() {
+  while (!path.empty()) {
+    int64_t lo = zdd->node(path.back()).lo;
+    path.pop_back();
+    options.pop_back();
+    if (lo != bottom) {
+      descend(lo);
+      return *this;
+    }
+  }
+  zdd = nullptr;
+  return *this;
+}
+
+} // namespace algorithm_x
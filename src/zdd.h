@@ -0,0 +1,121 @@
+#ifndef ZDD_H
+#define ZDD_H
+
+#include "algorithm_x.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace algorithm_x {
+
+/* A Zdd holds the solutions of an exact cover problem as a zero-suppressed
+ * decision diagram, as built by Knuth's Algorithm Z. Each branch node names an
+ * option, and leads to its hi child if the option is chosen and to its lo child
+ * if it is not; a solution is a path from the root to the top terminal, and the
+ * options on it whose hi branches were taken. Subproblems reached by many
+ * partial solutions are shared, so a Zdd can be exponentially smaller than the
+ * list of solutions it represents.
+ *
+ * Nodes are numbered so that children come before their parents, with the
+ * terminals bottom (no solutions) and top (the empty solution) first.
+ */
+class Zdd {
+public:
+  static constexpr int64_t bottom = 0;
+  static constexpr int64_t top = 1;
+
+  struct Node {
+    int64_t option; // the index of the option, or -1 for a terminal
+    int64_t lo;
+    int64_t hi;
+  };
+
+  class SolutionRange;
+
+  Zdd();
+
+  int64_t root() const { return root_node; }
+  const Node &node(int64_t k) const { return nodes[k]; }
+  // size() counts the nodes, including both terminals.
+  int64_t size() const { return nodes.size(); }
+
+  /* count_solutions() adds up the paths to the top terminal, in time linear in
+   * the size of the Zdd.
+   */
+  uint64_t count_solutions() const;
+  /* solutions() walks the paths to the top terminal one at a time, giving each
+   * solution as the indices of its options, e.g.
+   *   for (const SolutionView &solution : zdd.solutions()) { ... }
+   */
+  SolutionRange solutions() const;
+
+private:
+  template <typename Index> friend class BasicExactCoverProblem;
+
+  struct NodeHash {
+    std::size_t operator()(const Node &node) const;
+  };
+  struct NodeEqual {
+    bool operator()(const Node &a, const Node &b) const;
+  };
+
+  /* make_node() returns the node with the given fields, creating it only if
+   * there is no such node yet. A branch whose hi child is the bottom terminal
+   * is suppressed in favor of its lo child.
+   */
+  int64_t make_node(int64_t option, int64_t lo, int64_t hi);
+
+  std::vector<Node> nodes;
+  std::unordered_map<Node, int64_t, NodeHash, NodeEqual> unique_table;
+  int64_t root_node;
+};
+
+/* A Zdd::SolutionRange is the input range returned by Zdd::solutions(). Its
+ * iterator keeps the current path, and advancing it backtracks to the last
+ * node whose lo branch is still untaken. Solutions with an option come before
+ * those without it, as in the search that built the Zdd.
+ */
+class Zdd::SolutionRange {
+public:
+  class iterator {
+  public:
+    // The view is only valid until the iterator is advanced.
+    SolutionView operator*() const { return SolutionView(options); }
+    iterator &operator++();
+    bool operator==(const iterator &other) const {
+      return zdd == other.zdd;
+    }
+    bool operator!=(const iterator &other) const {
+      return zdd != other.zdd;
+    }
+
+  private:
+    friend class SolutionRange;
+    explicit iterator(const Zdd *zdd) : zdd(zdd) {}
+    iterator() : zdd(nullptr) {}
+
+    /* descend() follows hi branches from node k down to the top terminal,
+     * since no hi branch leads to the bottom one.
+     */
+    void descend(int64_t k);
+
+    const Zdd *zdd; // null once every solution has been visited
+    /* The nodes on the current path whose hi branches were taken, and their
+     * options. The nodes whose lo branches were taken need no record, as they
+     * have no branches left to take.
+     */
+    std::vector<int64_t> path;
+    std::vector<int64_t> options;
+  };
+
+  explicit SolutionRange(const Zdd *zdd) : zdd(zdd) {}
+  iterator begin() const;
+  iterator end() const { return iterator(); }
+
+private:
+  const Zdd *zdd;
+};
+
+} // namespace algorithm_x
+
+#endif // #define ZDD_H